@@ -0,0 +1,236 @@
+#pragma once
+
+#include <coroutine>
+#include <exception>
+#include <memory>
+
+// -----------------------------------------------------------------------------
+
+namespace ctl
+{
+    // A lazily evaluated stream of values. The generator body produces values with
+    // co_yield and the consumer pulls them with:
+    //
+    //     while (co_await generator.next())
+    //     {
+    //         use(generator.value());
+    //     }
+    //
+    // Control is transferred symmetrically between the consumer and the generator,
+    // so the generator always runs on whichever task_queue worker is running the
+    // consumer. Yielded values are handed over by reference and never copied; a
+    // value is only valid until the next call to next().
+    //
+    // A generator body may co_await the next() of another async_generator, which
+    // allows generators to be chained into transforms.
+    template< typename T >
+    class async_generator
+    {
+    public:
+
+        using value_type = T;
+
+        struct promise_type
+        {
+            struct yield_awaiter
+            {
+                bool await_ready() noexcept
+                {
+                    return false;
+                }
+
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> coroutine) noexcept
+                {
+                    return coroutine.promise().m_continuation;
+                }
+
+                void await_resume() noexcept
+                {
+                }
+            };
+
+            // -----------------------------------------------------------------------------
+
+            async_generator get_return_object()
+            {
+                return async_generator(std::coroutine_handle<promise_type>::from_promise(*this));
+            }
+
+            auto initial_suspend() noexcept { return std::suspend_always(); }
+
+            yield_awaiter final_suspend() noexcept
+            {
+                m_value = nullptr;
+                return yield_awaiter();
+            }
+
+            yield_awaiter yield_value(T& value) noexcept
+            {
+                m_value = std::addressof(value);
+                return yield_awaiter();
+            }
+
+            yield_awaiter yield_value(T&& value) noexcept
+            {
+                m_value = std::addressof(value);
+                return yield_awaiter();
+            }
+
+            void return_void() {}
+
+            void unhandled_exception()
+            {
+                m_exception = std::current_exception();
+            }
+
+            void set_continuation(std::coroutine_handle<> continuation)
+            {
+                m_continuation = continuation;
+            }
+
+            T& value() const
+            {
+                return *m_value;
+            }
+
+            void rethrow_if_exception()
+            {
+                if (m_exception)
+                {
+                    std::rethrow_exception(m_exception);
+                }
+            }
+
+        private:
+
+            std::coroutine_handle<> m_continuation;
+            T* m_value = nullptr;
+            std::exception_ptr m_exception;
+        };
+
+        // -----------------------------------------------------------------------------
+
+        struct next_awaiter
+        {
+            explicit next_awaiter(std::coroutine_handle<promise_type> coroutine)
+                : m_coroutine(coroutine)
+            {
+            }
+
+            bool await_ready() noexcept
+            {
+                return !m_coroutine || m_coroutine.done();
+            }
+
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> consumer) noexcept
+            {
+                m_coroutine.promise().set_continuation(consumer);
+                return m_coroutine;
+            }
+
+            bool await_resume()
+            {
+                if (!m_coroutine)
+                {
+                    return false;
+                }
+
+                m_coroutine.promise().rethrow_if_exception();
+
+                return !m_coroutine.done();
+            }
+
+        private:
+
+            std::coroutine_handle<promise_type> m_coroutine;
+        };
+
+        // -----------------------------------------------------------------------------
+
+        explicit async_generator(std::coroutine_handle<promise_type> coroutine)
+            : m_coroutine(coroutine)
+        {
+        }
+
+        // -----------------------------------------------------------------------------
+
+        async_generator() = default;
+        async_generator(async_generator&& other)
+            : m_coroutine(other.m_coroutine)
+        {
+            other.m_coroutine = nullptr;
+        }
+
+        // -----------------------------------------------------------------------------
+
+        async_generator& operator=(async_generator&& other)
+        {
+            if (this != &other)
+            {
+                if (m_coroutine)
+                {
+                    m_coroutine.destroy();
+                }
+
+                m_coroutine = other.m_coroutine;
+                other.m_coroutine = nullptr;
+            }
+
+            return *this;
+        }
+
+        // -----------------------------------------------------------------------------
+
+        ~async_generator()
+        {
+            if (m_coroutine)
+            {
+                m_coroutine.destroy();
+            }
+        }
+
+        // -----------------------------------------------------------------------------
+
+        // Resumes the generator until it yields the next value or finishes. The
+        // awaited result is false once the generator has finished.
+        next_awaiter next()
+        {
+            return next_awaiter(m_coroutine);
+        }
+
+        // -----------------------------------------------------------------------------
+
+        // The most recently yielded value. Only valid after next() returned true.
+        T& value() const
+        {
+            return m_coroutine.promise().value();
+        }
+
+        // -----------------------------------------------------------------------------
+
+        bool valid() const
+        {
+            return !!m_coroutine;
+        }
+
+        // -----------------------------------------------------------------------------
+
+        bool complete() const
+        {
+            return m_coroutine.done();
+        }
+
+        // -----------------------------------------------------------------------------
+
+        async_generator(const async_generator&) = delete;
+        async_generator& operator=(const async_generator&) = delete;
+
+    private:
+
+        std::coroutine_handle<promise_type> m_coroutine;
+    };
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
@@ -0,0 +1,270 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+
+namespace ctl
+{
+    struct blocking_pool_metrics
+    {
+        // Blocking calls that ran on the pool instead of occupying a task_queue worker.
+        size_t offloadedCalls = 0;
+
+        // Calls that had to wait for a blocking thread because the pool was at its cap.
+        size_t saturatedCalls = 0;
+
+        size_t threadsStarted = 0;
+        size_t threadsReaped = 0;
+        size_t peakThreads = 0;
+    };
+
+    // -----------------------------------------------------------------------------
+
+    // An elastic set of threads for work that blocks. Threads are started on demand
+    // when no idle thread is available, up to a cap, and exit again once they have
+    // been idle for longer than the idle timeout.
+    class blocking_pool final
+    {
+    public:
+
+        static constexpr size_t default_max_threads = 64;
+        static constexpr std::chrono::milliseconds default_idle_timeout = std::chrono::seconds(10);
+
+        // -----------------------------------------------------------------------------
+
+        blocking_pool()
+            : m_mutex()
+            , m_waitForWork()
+            , m_threads()
+            , m_exitedThreads()
+            , m_work()
+            , m_maxThreads(default_max_threads)
+            , m_idleTimeout(default_idle_timeout)
+            , m_threadCount(0)
+            , m_idleThreads(0)
+            , m_metrics()
+            , m_stop(false)
+        {
+        }
+
+        // -----------------------------------------------------------------------------
+
+        ~blocking_pool()
+        {
+            std::vector<std::thread> threads;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+
+                m_stop = true;
+                m_waitForWork.notify_all();
+
+                threads.swap(m_threads);
+            }
+
+            for (std::thread& thread : threads)
+            {
+                thread.join();
+            }
+        }
+
+        // -----------------------------------------------------------------------------
+
+        blocking_pool(const blocking_pool&) = delete;
+        blocking_pool& operator=(const blocking_pool&) = delete;
+
+        // -----------------------------------------------------------------------------
+
+        void set_max_threads(const size_t maxThreads)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_maxThreads = maxThreads > 0 ? maxThreads : 1;
+        }
+
+        // -----------------------------------------------------------------------------
+
+        void set_idle_timeout(const std::chrono::milliseconds idleTimeout)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_idleTimeout = idleTimeout;
+        }
+
+        // -----------------------------------------------------------------------------
+
+        blocking_pool_metrics get_metrics() const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_metrics;
+        }
+
+        // -----------------------------------------------------------------------------
+
+        // Runs work on a blocking thread. Work must not throw.
+        void push(std::function<void()> work)
+        {
+            std::vector<std::thread> exitedThreads;
+            bool startThread = false;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+
+                m_work.push_back(std::move(work));
+                ++m_metrics.offloadedCalls;
+
+                if (m_work.size() > m_idleThreads)
+                {
+                    if (m_threadCount < m_maxThreads)
+                    {
+                        reserve_thread();
+                        exitedThreads = take_exited_threads();
+                        startThread = true;
+                    }
+                    else
+                    {
+                        ++m_metrics.saturatedCalls;
+                    }
+                }
+
+                m_waitForWork.notify_one();
+            }
+
+            for (std::thread& thread : exitedThreads)
+            {
+                thread.join();
+            }
+
+            if (startThread)
+            {
+                start_thread();
+            }
+        }
+
+        // -----------------------------------------------------------------------------
+
+    private:
+
+        // Called with the lock held. The thread is counted straight away, but only
+        // created by start_thread once the lock has been released.
+        void reserve_thread()
+        {
+            ++m_threadCount;
+            ++m_metrics.threadsStarted;
+
+            if (m_threadCount > m_metrics.peakThreads)
+            {
+                m_metrics.peakThreads = m_threadCount;
+            }
+        }
+
+        // -----------------------------------------------------------------------------
+
+        // Creating a thread is slow, so it is never done with the lock held, where it
+        // would stall every pusher and every blocking thread looking for work.
+        void start_thread()
+        {
+            std::thread thread([this]() { run_thread(); });
+
+            std::unique_lock<std::mutex> lock(m_mutex);
+
+            if (m_stop)
+            {
+                // The destructor has already taken the list, so the thread is joined here.
+                lock.unlock();
+                thread.join();
+                return;
+            }
+
+            m_threads.push_back(std::move(thread));
+        }
+
+        // -----------------------------------------------------------------------------
+
+        // Called with the lock held. Threads which were reaped have already left
+        // run_thread, so the caller can join them once it has released the lock. A
+        // thread which was reaped before start_thread added it to the list is left
+        // for a later call.
+        std::vector<std::thread> take_exited_threads()
+        {
+            std::vector<std::thread> exitedThreads;
+
+            for (auto id = m_exitedThreads.begin(); id != m_exitedThreads.end(); )
+            {
+                auto iter = std::find_if(m_threads.begin(), m_threads.end(), [&id](const std::thread& thread) { return thread.get_id() == *id; });
+
+                if (iter == m_threads.end())
+                {
+                    ++id;
+                    continue;
+                }
+
+                exitedThreads.push_back(std::move(*iter));
+                m_threads.erase(iter);
+                id = m_exitedThreads.erase(id);
+            }
+
+            return exitedThreads;
+        }
+
+        // -----------------------------------------------------------------------------
+
+        void run_thread()
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+
+            while (!m_stop)
+            {
+                if (m_work.empty())
+                {
+                    ++m_idleThreads;
+                    const bool woken = m_waitForWork.wait_for(lock, m_idleTimeout, [this]() { return m_stop || !m_work.empty(); });
+                    --m_idleThreads;
+
+                    if (!woken)
+                    {
+                        ++m_metrics.threadsReaped;
+                        m_exitedThreads.push_back(std::this_thread::get_id());
+                        break;
+                    }
+
+                    continue;
+                }
+
+                std::function<void()> work = std::move(m_work.front());
+                m_work.pop_front();
+
+                lock.unlock();
+                work();
+                lock.lock();
+            }
+
+            --m_threadCount;
+        }
+
+        // -----------------------------------------------------------------------------
+
+        mutable std::mutex m_mutex;
+        std::condition_variable m_waitForWork;
+        std::vector<std::thread> m_threads;
+        std::vector<std::thread::id> m_exitedThreads;
+
+        // -----------------------------------------------------------------------------
+
+        std::deque<std::function<void()>> m_work;
+        size_t m_maxThreads;
+        std::chrono::milliseconds m_idleTimeout;
+        size_t m_threadCount;
+        size_t m_idleThreads;
+        blocking_pool_metrics m_metrics;
+        bool m_stop;
+    };
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
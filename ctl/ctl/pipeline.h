@@ -0,0 +1,513 @@
+#pragma once
+
+#include <atomic>
+#include <coroutine>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+#include <ctl/async_generator.h>
+#include <ctl/ring_buffer.h>
+#include <ctl/task.h>
+#include <ctl/task_counter.h>
+#include <ctl/task_handle.h>
+#include <ctl/task_queue_context.h>
+
+// -----------------------------------------------------------------------------
+
+namespace ctl
+{
+    constexpr size_t default_pipeline_capacity = 64;
+
+    // -----------------------------------------------------------------------------
+
+    namespace impl
+    {
+        // Lets one side of a pipeline_channel sleep on the queue until the other side
+        // changes the state it is waiting on. Only one task ever waits on a signal.
+        class pipeline_signal
+        {
+        public:
+
+            pipeline_signal()
+                : m_mutex()
+                , m_counter()
+                , m_waiting(false)
+            {
+            }
+
+            // -----------------------------------------------------------------------------
+
+            // Waiting side. Publishes the counter to sleep on. The waiter must check its
+            // condition again afterwards and retract() if it no longer needs to sleep.
+            task_counter_ptr prepare_wait()
+            {
+                auto counter = std::make_shared<task_counter>(1u);
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_counter = counter;
+                }
+
+                m_waiting.store(true, std::memory_order_relaxed);
+
+                // Pairs with the fence in notify(), so that either the waiter sees the
+                // change or the notifier sees the waiter.
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+
+                return counter;
+            }
+
+            // -----------------------------------------------------------------------------
+
+            void retract()
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+
+                m_counter.reset();
+                m_waiting.store(false, std::memory_order_relaxed);
+            }
+
+            // -----------------------------------------------------------------------------
+
+            // Signalling side. Called after changing the state, from a task on the queue.
+            void notify()
+            {
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+
+                if (!m_waiting.load(std::memory_order_relaxed))
+                {
+                    return;
+                }
+
+                task_counter_ptr counter;
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+
+                    counter = std::move(m_counter);
+                    m_waiting.store(false, std::memory_order_relaxed);
+                }
+
+                if (counter)
+                {
+                    current_task_queue_context()->release_counter(counter.get());
+                }
+            }
+
+            // -----------------------------------------------------------------------------
+
+        private:
+
+            std::mutex m_mutex;
+            task_counter_ptr m_counter;
+            std::atomic<bool> m_waiting;
+        };
+
+        // -----------------------------------------------------------------------------
+
+        // Suspends the calling task on a signal until condition holds.
+        template< typename Condition >
+        class pipeline_wait
+        {
+        public:
+
+            pipeline_wait(pipeline_signal& signal, Condition condition)
+                : m_signal(signal)
+                , m_condition(std::move(condition))
+            {
+            }
+
+            bool await_ready()
+            {
+                return m_condition();
+            }
+
+            bool await_suspend(std::coroutine_handle<task_handle::promise_type> type)
+            {
+                task_counter_ptr counter = m_signal.prepare_wait();
+
+                if (m_condition())
+                {
+                    m_signal.retract();
+                    return false;
+                }
+
+                type.promise().set_counter(std::move(counter));
+
+                return true;
+            }
+
+            void await_resume()
+            {
+            }
+
+        private:
+
+            pipeline_signal& m_signal;
+            Condition m_condition;
+        };
+
+        // -----------------------------------------------------------------------------
+
+        // The bounded buffer between two stages, with the signals each side sleeps on.
+        // The producer closes it when it finishes, passing on any error, and the
+        // consumer cancels it when it stops early so that the producer stops too.
+        template< typename T >
+        class pipeline_channel
+        {
+        public:
+
+            explicit pipeline_channel(const size_t capacity)
+                : m_buffer(capacity)
+                , m_readable()
+                , m_writable()
+                , m_error()
+                , m_cancelled(false)
+            {
+            }
+
+            // -----------------------------------------------------------------------------
+
+            // Producer side. Returns false without touching the value when full.
+            bool try_push(T&& value)
+            {
+                if (!m_buffer.try_push(std::move(value)))
+                {
+                    return false;
+                }
+
+                m_readable.notify();
+
+                return true;
+            }
+
+            // -----------------------------------------------------------------------------
+
+            // Producer side. Resumes once there is space or the consumer has cancelled.
+            auto writable()
+            {
+                return pipeline_wait(m_writable, [this]() { return !m_buffer.full() || cancelled(); });
+            }
+
+            // -----------------------------------------------------------------------------
+
+            // Producer side.
+            bool cancelled() const
+            {
+                return m_cancelled.load(std::memory_order_acquire);
+            }
+
+            // -----------------------------------------------------------------------------
+
+            // Producer side. The error, if any, is handed on once every item is consumed.
+            void close(std::exception_ptr error)
+            {
+                m_error = std::move(error);
+                m_buffer.close();
+                m_readable.notify();
+            }
+
+            // -----------------------------------------------------------------------------
+
+            // Consumer side. Returns the oldest item, or nullptr when empty.
+            T* front()
+            {
+                return m_buffer.front();
+            }
+
+            // -----------------------------------------------------------------------------
+
+            // Consumer side.
+            void pop()
+            {
+                m_buffer.pop();
+                m_writable.notify();
+            }
+
+            // -----------------------------------------------------------------------------
+
+            // Consumer side. Resumes once there is an item or the producer has closed.
+            auto readable()
+            {
+                return pipeline_wait(m_readable, [this]() { return m_buffer.front() != nullptr || m_buffer.drained(); });
+            }
+
+            // -----------------------------------------------------------------------------
+
+            // Consumer side.
+            bool drained() const
+            {
+                return m_buffer.drained();
+            }
+
+            // -----------------------------------------------------------------------------
+
+            // Consumer side. Only valid once drained.
+            std::exception_ptr get_error() const
+            {
+                return m_error;
+            }
+
+            // -----------------------------------------------------------------------------
+
+            // Consumer side. Stops the producer, waking it if it is waiting for space.
+            void cancel()
+            {
+                m_cancelled.store(true, std::memory_order_release);
+                m_writable.notify();
+            }
+
+            // -----------------------------------------------------------------------------
+
+        private:
+
+            spsc_ring_buffer<T> m_buffer;
+            pipeline_signal m_readable;
+            pipeline_signal m_writable;
+            std::exception_ptr m_error;
+            std::atomic<bool> m_cancelled;
+        };
+
+        // -----------------------------------------------------------------------------
+
+        template< typename T >
+        using pipeline_channel_ptr = std::shared_ptr<pipeline_channel<T>>;
+
+        // -----------------------------------------------------------------------------
+
+        struct ignore_pipeline_error
+        {
+            void operator()(std::exception_ptr) const
+            {
+            }
+        };
+
+        // -----------------------------------------------------------------------------
+
+        // Stage bodies are free functions rather than lambdas so that everything they
+        // use lives in the coroutine frame and survives the task being moved around
+        // the queue while it is suspended. Every exit path closes the output, so a
+        // failing stage can never leave the stages after it waiting forever.
+        template< typename F, typename T >
+        task_handle run_pipeline_source(F source, pipeline_channel_ptr<T> output)
+        {
+            std::exception_ptr error;
+
+            try
+            {
+                auto generator = source();
+
+                for (bool hasValue = co_await generator.next(); hasValue; hasValue = co_await generator.next())
+                {
+                    while (!output->try_push(std::move(generator.value())) && !output->cancelled())
+                    {
+                        co_await output->writable();
+                    }
+
+                    if (output->cancelled())
+                    {
+                        break;
+                    }
+                }
+            }
+            catch (...)
+            {
+                error = std::current_exception();
+            }
+
+            output->close(std::move(error));
+        }
+
+        // -----------------------------------------------------------------------------
+
+        template< typename F, typename T, typename U >
+        task_handle run_pipeline_stage(F stage, pipeline_channel_ptr<T> input, pipeline_channel_ptr<U> output)
+        {
+            std::exception_ptr error;
+
+            try
+            {
+                while (!output->cancelled())
+                {
+                    T* item = input->front();
+
+                    if (item == nullptr)
+                    {
+                        if (input->drained())
+                        {
+                            error = input->get_error();
+                            break;
+                        }
+
+                        co_await input->readable();
+                        continue;
+                    }
+
+                    U result = stage(*item);
+                    input->pop();
+
+                    while (!output->try_push(std::move(result)) && !output->cancelled())
+                    {
+                        co_await output->writable();
+                    }
+                }
+            }
+            catch (...)
+            {
+                error = std::current_exception();
+            }
+
+            input->cancel();
+            output->close(std::move(error));
+        }
+
+        // -----------------------------------------------------------------------------
+
+        template< typename F, typename E, typename T >
+        task_handle run_pipeline_sink(F sink, E onError, pipeline_channel_ptr<T> input)
+        {
+            std::exception_ptr error;
+
+            try
+            {
+                while (true)
+                {
+                    T* item = input->front();
+
+                    if (item == nullptr)
+                    {
+                        if (input->drained())
+                        {
+                            error = input->get_error();
+                            break;
+                        }
+
+                        co_await input->readable();
+                        continue;
+                    }
+
+                    sink(*item);
+                    input->pop();
+                }
+            }
+            catch (...)
+            {
+                error = std::current_exception();
+            }
+
+            input->cancel();
+
+            if (error)
+            {
+                onError(error);
+            }
+        }
+    }
+
+    // -----------------------------------------------------------------------------
+
+    // A chain of stages connected by bounded ring buffers. Each stage runs as its own
+    // task, so stages progress concurrently on different task_queue workers. A stage
+    // that finds its input empty or its output full sleeps on a counter which the
+    // neighbouring stage releases, giving its worker back to the queue until then.
+    // This provides backpressure and keeps the memory used by a pipeline fixed
+    // regardless of how long the stream is.
+    //
+    //     auto counter = ctl::make_pipeline([]() { return read_chunks(); })
+    //         .then([](chunk& c) { return parse(c); })
+    //         .run(queue, [](record& r) { store(r); });
+    //
+    // Items are moved into each buffer and processed in place, so they are never
+    // copied between stages.
+    //
+    // If the generator or any stage throws, the pipeline stops: items already past the
+    // failed stage are still delivered, the stages before it stop producing, and the
+    // exception is passed to the error handler given to run().
+    //
+    // then() and run() consume the pipeline they are called on, so they can only be
+    // called on a temporary or a pipeline that has been moved from explicitly.
+    template< typename T >
+    class pipeline
+    {
+    public:
+
+        using value_type = T;
+
+        pipeline(std::vector<task_function> stages, impl::pipeline_channel_ptr<T> output)
+            : m_stages(std::move(stages))
+            , m_output(std::move(output))
+        {
+        }
+
+        // -----------------------------------------------------------------------------
+
+        // Adds a stage which transforms each item. The stage is called with a
+        // reference to the item and its result is passed on to the next stage.
+        template< typename F >
+        auto then(F stage, const size_t capacity = default_pipeline_capacity) &&
+        {
+            using result_type = std::decay_t<std::invoke_result_t<F&, T&>>;
+
+            auto output = std::make_shared<impl::pipeline_channel<result_type>>(capacity);
+
+            std::vector<task_function> stages = std::move(m_stages);
+            stages.emplace_back([stage = std::move(stage), input = m_output, output]()
+            {
+                return impl::run_pipeline_stage(stage, input, output);
+            });
+
+            return pipeline<result_type>(std::move(stages), std::move(output));
+        }
+
+        // -----------------------------------------------------------------------------
+
+        // Terminates the pipeline with a sink that is called for each item and pushes
+        // every stage to the queue. The returned counter reaches zero once the whole
+        // stream has been consumed, or once every stage has stopped after an error,
+        // in which case onError has been called with it first.
+        template< typename Queue, typename F, typename E = impl::ignore_pipeline_error >
+        task_counter_ptr run(Queue& queue, F sink, E onError = E()) &&
+        {
+            std::vector<task_function> stages = std::move(m_stages);
+            stages.emplace_back([sink = std::move(sink), onError = std::move(onError), input = m_output]()
+            {
+                return impl::run_pipeline_sink(sink, onError, input);
+            });
+
+            return queue.push_waitable_tasks(stages);
+        }
+
+        // -----------------------------------------------------------------------------
+
+    private:
+
+        std::vector<task_function> m_stages;
+        impl::pipeline_channel_ptr<T> m_output;
+    };
+
+    // -----------------------------------------------------------------------------
+
+    // Starts a pipeline from a function returning the async_generator which
+    // produces the stream.
+    template< typename F >
+    auto make_pipeline(F source, const size_t capacity = default_pipeline_capacity)
+    {
+        using generator_type = std::invoke_result_t<F&>;
+        using value_type = typename generator_type::value_type;
+
+        auto output = std::make_shared<impl::pipeline_channel<value_type>>(capacity);
+
+        std::vector<task_function> stages;
+        stages.emplace_back([source = std::move(source), output]()
+        {
+            return impl::run_pipeline_source(source, output);
+        });
+
+        return pipeline<value_type>(std::move(stages), std::move(output));
+    }
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
@@ -0,0 +1,275 @@
+#pragma once
+
+#include <atomic>
+#include <optional>
+#include <utility>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+
+namespace ctl
+{
+    namespace impl
+    {
+        constexpr size_t cache_line_size = 64;
+
+        // -----------------------------------------------------------------------------
+
+        constexpr size_t round_up_to_power_of_two(const size_t value)
+        {
+            size_t result = 1;
+
+            while (result < value)
+            {
+                result <<= 1;
+            }
+
+            return result;
+        }
+
+        // -----------------------------------------------------------------------------
+
+        // Unsynchronised double-ended queue over a power-of-two array. Pushing and
+        // popping at either end never shifts items; the storage only grows, by
+        // doubling, when it is full.
+        template< typename T >
+        class ring_buffer
+        {
+        public:
+
+            explicit ring_buffer(const size_t capacity = 64)
+                : m_items(round_up_to_power_of_two(capacity > 0 ? capacity : 1))
+                , m_head(0)
+                , m_size(0)
+            {
+            }
+
+            // -----------------------------------------------------------------------------
+
+            bool empty() const
+            {
+                return m_size == 0;
+            }
+
+            // -----------------------------------------------------------------------------
+
+            size_t size() const
+            {
+                return m_size;
+            }
+
+            // -----------------------------------------------------------------------------
+
+            size_t capacity() const
+            {
+                return m_items.size();
+            }
+
+            // -----------------------------------------------------------------------------
+
+            void reserve(const size_t capacity)
+            {
+                if (capacity > m_items.size())
+                {
+                    grow(round_up_to_power_of_two(capacity));
+                }
+            }
+
+            // -----------------------------------------------------------------------------
+
+            void push_back(T&& item)
+            {
+                if (m_size == m_items.size())
+                {
+                    grow(m_items.size() * 2);
+                }
+
+                m_items[(m_head + m_size) & (m_items.size() - 1)] = std::move(item);
+                ++m_size;
+            }
+
+            // -----------------------------------------------------------------------------
+
+            template< typename... Args >
+            void emplace_back(Args&&... args)
+            {
+                push_back(T(std::forward<Args>(args)...));
+            }
+
+            // -----------------------------------------------------------------------------
+
+            void push_front(T&& item)
+            {
+                if (m_size == m_items.size())
+                {
+                    grow(m_items.size() * 2);
+                }
+
+                m_head = (m_head - 1) & (m_items.size() - 1);
+                m_items[m_head] = std::move(item);
+                ++m_size;
+            }
+
+            // -----------------------------------------------------------------------------
+
+            T pop_front()
+            {
+                T item = std::move(m_items[m_head]);
+
+                m_head = (m_head + 1) & (m_items.size() - 1);
+                --m_size;
+
+                return item;
+            }
+
+            // -----------------------------------------------------------------------------
+
+            T pop_back()
+            {
+                --m_size;
+
+                return std::move(m_items[(m_head + m_size) & (m_items.size() - 1)]);
+            }
+
+            // -----------------------------------------------------------------------------
+
+        private:
+
+            void grow(const size_t capacity)
+            {
+                std::vector<T> items(capacity);
+
+                for (size_t i = 0; i < m_size; ++i)
+                {
+                    items[i] = std::move(m_items[(m_head + i) & (m_items.size() - 1)]);
+                }
+
+                m_items = std::move(items);
+                m_head = 0;
+            }
+
+            // -----------------------------------------------------------------------------
+
+            std::vector<T> m_items;
+            size_t m_head;
+            size_t m_size;
+        };
+
+        // -----------------------------------------------------------------------------
+
+        // Bounded single producer / single consumer ring buffer. Items are moved in
+        // once and consumed in place through front(), so nothing is copied between
+        // the two sides. The storage is allocated up front and never grows.
+        template< typename T >
+        class spsc_ring_buffer
+        {
+        public:
+
+            explicit spsc_ring_buffer(const size_t capacity)
+                : m_slots(round_up_to_power_of_two(capacity > 0 ? capacity : 1))
+                , m_mask(m_slots.size() - 1)
+                , m_closed(false)
+                , m_head(0)
+                , m_tail(0)
+            {
+            }
+
+            // -----------------------------------------------------------------------------
+
+            spsc_ring_buffer(const spsc_ring_buffer&) = delete;
+            spsc_ring_buffer& operator=(const spsc_ring_buffer&) = delete;
+
+            // -----------------------------------------------------------------------------
+
+            size_t capacity() const
+            {
+                return m_slots.size();
+            }
+
+            // -----------------------------------------------------------------------------
+
+            // Producer side. Returns false without touching the value when full.
+            bool try_push(T&& value)
+            {
+                const size_t tail = m_tail.load(std::memory_order_relaxed);
+
+                if (tail - m_head.load(std::memory_order_acquire) == m_slots.size())
+                {
+                    return false;
+                }
+
+                m_slots[tail & m_mask].emplace(std::move(value));
+                m_tail.store(tail + 1, std::memory_order_release);
+
+                return true;
+            }
+
+            // -----------------------------------------------------------------------------
+
+            // Producer side.
+            bool full() const
+            {
+                return m_tail.load(std::memory_order_relaxed) - m_head.load(std::memory_order_acquire) == m_slots.size();
+            }
+
+            // -----------------------------------------------------------------------------
+
+            // Producer side. No more items will be pushed after this.
+            void close()
+            {
+                m_closed.store(true, std::memory_order_release);
+            }
+
+            // -----------------------------------------------------------------------------
+
+            // Consumer side. Returns the oldest item, or nullptr when empty. The item
+            // stays in its slot until pop() is called.
+            T* front()
+            {
+                const size_t head = m_head.load(std::memory_order_relaxed);
+
+                if (head == m_tail.load(std::memory_order_acquire))
+                {
+                    return nullptr;
+                }
+
+                return &*m_slots[head & m_mask];
+            }
+
+            // -----------------------------------------------------------------------------
+
+            // Consumer side. Releases the slot returned by front().
+            void pop()
+            {
+                const size_t head = m_head.load(std::memory_order_relaxed);
+
+                m_slots[head & m_mask].reset();
+                m_head.store(head + 1, std::memory_order_release);
+            }
+
+            // -----------------------------------------------------------------------------
+
+            // Consumer side. True once the producer has closed and every item is consumed.
+            bool drained() const
+            {
+                return m_closed.load(std::memory_order_acquire)
+                    && m_head.load(std::memory_order_relaxed) == m_tail.load(std::memory_order_acquire);
+            }
+
+            // -----------------------------------------------------------------------------
+
+        private:
+
+            std::vector<std::optional<T>> m_slots;
+            const size_t m_mask;
+            std::atomic<bool> m_closed;
+
+            alignas(cache_line_size) std::atomic<size_t> m_head;
+            alignas(cache_line_size) std::atomic<size_t> m_tail;
+        };
+    }
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <type_traits>
+
+#include <ctl/task_handle.h>
+#include <ctl/task_queue_context.h>
+
+// -----------------------------------------------------------------------------
+
+namespace ctl
+{
+    namespace impl
+    {
+        template< typename F, typename R = std::invoke_result_t<F&> >
+        class blocking_awaiter
+        {
+        public:
+
+            explicit blocking_awaiter(F func)
+                : m_func(std::move(func))
+                , m_result()
+                , m_exception()
+            {
+            }
+
+            bool await_ready()
+            {
+                return false;
+            }
+
+            bool await_suspend(std::coroutine_handle<ctl::task_handle::promise_type> type)
+            {
+                task_queue_context* const queue = current_task_queue_context();
+
+                // Off the queue's threads there is no worker to protect, so run inline.
+                task_counter_ptr counter = queue ? queue->push_blocking_work([this]() { invoke(); }) : nullptr;
+
+                if (!counter)
+                {
+                    invoke();
+                    return false;
+                }
+
+                type.promise().set_counter(std::move(counter));
+
+                return true;
+            }
+
+            R await_resume()
+            {
+                if (m_exception)
+                {
+                    std::rethrow_exception(m_exception);
+                }
+
+                if constexpr (!std::is_void_v<R>)
+                {
+                    return std::move(*m_result);
+                }
+            }
+
+        private:
+
+            void invoke()
+            {
+                try
+                {
+                    if constexpr (std::is_void_v<R>)
+                    {
+                        m_func();
+                    }
+                    else
+                    {
+                        m_result.emplace(m_func());
+                    }
+                }
+                catch (...)
+                {
+                    m_exception = std::current_exception();
+                }
+            }
+
+            struct no_result {};
+
+            F m_func;
+            std::optional<std::conditional_t<std::is_void_v<R>, no_result, R>> m_result;
+            std::exception_ptr m_exception;
+        };
+    }
+
+    // -----------------------------------------------------------------------------
+
+    // Runs a blocking function on the blocking pool of the queue running the calling
+    // task, whatever its policies, and suspends the task until it returns, so the
+    // worker is free to run other tasks in the meantime. The result of the function,
+    // or the exception it threw, is returned from the co_await.
+    //
+    //     auto bytes = co_await ctl::run_blocking([&]() { return file.read(buffer); });
+    template< typename F >
+    impl::blocking_awaiter<F> run_blocking(F func)
+    {
+        return impl::blocking_awaiter<F>(std::move(func));
+    }
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
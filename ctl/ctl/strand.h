@@ -0,0 +1,215 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+
+#include <ctl/ring_buffer.h>
+#include <ctl/task.h>
+#include <ctl/task_counter.h>
+#include <ctl/task_handle.h>
+#include <ctl/task_queue.h>
+
+// -----------------------------------------------------------------------------
+
+namespace ctl
+{
+    constexpr size_t default_strand_batch_size = 16;
+
+    // -----------------------------------------------------------------------------
+
+    namespace impl
+    {
+        struct strand_item
+        {
+            task_function m_function;
+            task_counter_ptr m_counter;
+        };
+
+        // -----------------------------------------------------------------------------
+
+        class strand_state
+        {
+        public:
+
+            explicit strand_state(const size_t batchSize)
+                : m_mutex()
+                , m_items()
+                , m_batchSize(batchSize > 0 ? batchSize : 1)
+                , m_scheduled(false)
+            {
+            }
+
+            // -----------------------------------------------------------------------------
+
+            // Returns true if the strand was idle, in which case the caller must schedule it.
+            bool push(strand_item item)
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+
+                m_items.push_back(std::move(item));
+
+                const bool schedule = !m_scheduled;
+                m_scheduled = true;
+
+                return schedule;
+            }
+
+            // -----------------------------------------------------------------------------
+
+            // Returns false once the strand is empty, marking it as no longer scheduled.
+            bool try_pop(strand_item& item)
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+
+                if (m_items.empty())
+                {
+                    m_scheduled = false;
+                    return false;
+                }
+
+                item = m_items.pop_front();
+
+                return true;
+            }
+
+            // -----------------------------------------------------------------------------
+
+            size_t get_batch_size() const
+            {
+                return m_batchSize;
+            }
+
+            // -----------------------------------------------------------------------------
+
+        private:
+
+            std::mutex m_mutex;
+            ring_buffer<strand_item> m_items;
+            const size_t m_batchSize;
+            bool m_scheduled;
+        };
+
+        // -----------------------------------------------------------------------------
+
+        // The single queue entry of a scheduled strand. Runs items one at a time, each
+        // to completion, and gives its slot back to the queue after each batch so that
+        // a busy strand cannot starve other tasks.
+        template< typename Queue >
+        task_handle run_strand(std::shared_ptr<strand_state> state, Queue* queue)
+        {
+            while (true)
+            {
+                for (size_t i = 0; i < state->get_batch_size(); ++i)
+                {
+                    strand_item item;
+
+                    if (!state->try_pop(item))
+                    {
+                        co_return;
+                    }
+
+                    // A callable which throws before returning its task_handle is dropped,
+                    // as it would be on the queue itself. Its counter is still released and
+                    // the strand carries on, rather than ending with the strand still
+                    // marked as scheduled.
+                    try
+                    {
+                        scoped_task_handle scoped{ item.m_function() };
+
+                        while (!scoped.m_handle.complete())
+                        {
+                            co_await suspend_until(scoped.m_handle.get_counter());
+                            scoped.m_handle.resume();
+                        }
+                    }
+                    catch (...)
+                    {
+                    }
+
+                    queue->release_counter(item.m_counter.get());
+                }
+
+                co_await std::suspend_always();
+            }
+        }
+    }
+
+    // -----------------------------------------------------------------------------
+
+    // Serialises the tasks pushed to it. They run on the task_queue in the order they
+    // were pushed, and a task never starts until the previous one has completed,
+    // including any time it spends suspended. State owned by a single strand can
+    // therefore be used from its tasks without locking.
+    //
+    // A strand occupies at most one entry of the queue at a time and runs up to
+    // batchSize of its tasks each time that entry is scheduled.
+    template< typename Queue >
+    class basic_strand final
+    {
+        static_assert(Queue::policies::wake_policy::threaded, "Strands need a task queue which can be run from several threads");
+
+    public:
+
+        explicit basic_strand(Queue& taskQueue, const size_t batchSize = default_strand_batch_size)
+            : m_taskQueue(taskQueue)
+            , m_state(std::make_shared<impl::strand_state>(batchSize))
+        {
+        }
+
+        // -----------------------------------------------------------------------------
+
+        basic_strand(const basic_strand&) = delete;
+        basic_strand& operator=(const basic_strand&) = delete;
+
+        // -----------------------------------------------------------------------------
+
+        template< typename T >
+        task_counter_ptr push_waitable_task(T task)
+        {
+            static_assert(Queue::policies::counter_policy::enabled, "This task queue was configured without counters");
+
+            auto counter = std::make_shared<task_counter>(1u);
+
+            push_task_impl(std::move(task), counter);
+
+            return counter;
+        }
+
+        // -----------------------------------------------------------------------------
+
+        template< typename T >
+        void push_task(T task)
+        {
+            push_task_impl(std::move(task), nullptr);
+        }
+
+        // -----------------------------------------------------------------------------
+
+    private:
+
+        template< typename T >
+        void push_task_impl(T task, task_counter_ptr counter)
+        {
+            if (m_state->push(impl::strand_item{ std::move(task), std::move(counter) }))
+            {
+                m_taskQueue.push_task([state = m_state, queue = &m_taskQueue]()
+                {
+                    return impl::run_strand(state, queue);
+                });
+            }
+        }
+
+        // -----------------------------------------------------------------------------
+
+        Queue& m_taskQueue;
+        std::shared_ptr<impl::strand_state> m_state;
+    };
+
+    // -----------------------------------------------------------------------------
+
+    using strand = basic_strand<task_queue>;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <coroutine>
 #include <functional>
 
 #include <ctl/task_counter.h>
@@ -17,20 +18,86 @@ namespace ctl
     namespace impl
     {
 
-        class task
+        // The coroutine a task runs in while it is on the queue. It is created
+        // suspended when the task is pushed, owns the callable and any completion
+        // counter, and drives the task_handle the callable returns.
+        struct task_frame
         {
-        public:
+            struct promise_type
+            {
+                task_frame get_return_object()
+                {
+                    return task_frame{ std::coroutine_handle<promise_type>::from_promise(*this) };
+                }
+
+                auto initial_suspend() noexcept { return std::suspend_always(); }
+                auto final_suspend() noexcept { return std::suspend_always(); }
+
+                void return_void() {}
+
+                void unhandled_exception() {}
+
+                void set_suspended_handle(const task_handle* handle)
+                {
+                    m_suspendedHandle = handle;
+                }
+
+                const_task_counter_ptr get_waiting_counter() const
+                {
+                    return m_suspendedHandle->get_counter();
+                }
+
+                bool waiting() const
+                {
+                    return m_suspendedHandle && m_suspendedHandle->waiting();
+                }
+
+            private:
+
+                // The handle lives in the frame, so while the frame is suspended this
+                // stays valid and the counter it waits on needs no second reference.
+                const task_handle* m_suspendedHandle = nullptr;
+            };
 
-            task()
-                : m_task()
-                , m_handle()
-                , m_counter()
+            // -----------------------------------------------------------------------------
+
+            std::coroutine_handle<promise_type> m_coroutine;
+        };
+
+        // -----------------------------------------------------------------------------
+
+        // Suspends the frame, publishing the task_handle whose counter it is waiting on.
+        struct suspend_task_frame
+        {
+            explicit suspend_task_frame(const task_handle& handle)
+                : m_handle(handle)
             {
             }
 
-            // -----------------------------------------------------------------------------
+            bool await_ready()
+            {
+                return false;
+            }
+
+            void await_suspend(std::coroutine_handle<task_frame::promise_type> type)
+            {
+                type.promise().set_suspended_handle(&m_handle);
+            }
 
-            ~task()
+            void await_resume()
+            {
+            }
+
+        private:
+
+            const task_handle& m_handle;
+        };
+
+        // -----------------------------------------------------------------------------
+
+        struct scoped_task_handle
+        {
+            ~scoped_task_handle()
             {
                 if (m_handle.valid())
                 {
@@ -38,33 +105,127 @@ namespace ctl
                 }
             }
 
+            task_handle m_handle;
+        };
+
+        // -----------------------------------------------------------------------------
+
+        // The callable and the completion counter, when there is one, are parameters
+        // so that they are stored in the frame, which keeps any lambda captures at a
+        // fixed address for as long as the task_handle it returns is alive.
+        template< typename F, typename... Counter >
+        task_frame make_task_frame(F func, [[maybe_unused]] Counter... counter)
+        {
+            scoped_task_handle scoped{ func() };
+
+            while (!scoped.m_handle.complete())
+            {
+                co_await suspend_task_frame(scoped.m_handle);
+                scoped.m_handle.resume();
+            }
+        }
+
+        // -----------------------------------------------------------------------------
+
+        template< bool StoreCounter >
+        class task_counter_slot
+        {
+        protected:
+
+            task_counter* m_counter = nullptr;
+        };
+
+        // -----------------------------------------------------------------------------
+
+        template<>
+        class task_counter_slot<false>
+        {
+        protected:
+
+            static constexpr task_counter* m_counter = nullptr;
+        };
+
+        // -----------------------------------------------------------------------------
+
+        // A queued task. Only the suspended frame and, when StoreCounter is set, a
+        // pointer to its completion counter are stored, keeping the record small
+        // enough for several to share a cache line. The counter itself is owned by
+        // the frame.
+        template< bool StoreCounter >
+        class basic_task : private task_counter_slot<StoreCounter>
+        {
+            using task_counter_slot<StoreCounter>::m_counter;
+
+        public:
+
+            basic_task()
+                : m_frame()
+            {
+            }
+
+            // -----------------------------------------------------------------------------
+
+            ~basic_task()
+            {
+                if (m_frame)
+                {
+                    m_frame.destroy();
+                }
+            }
+
             // -----------------------------------------------------------------------------
 
-            task(task_function func, task_counter_ptr counter)
-                : m_handle()
-                , m_task(std::move(func))
-                , m_counter(std::move(counter))
+            template< typename F >
+            basic_task(F func, task_counter_ptr counter) requires (StoreCounter)
+                : m_frame()
             {
+                m_counter = counter.get();
+                m_frame = make_task_frame(std::move(func), std::move(counter)).m_coroutine;
             }
 
+            // -----------------------------------------------------------------------------
 
-            task(const task&) = delete;
-            task(task&& other)
-                : m_handle(std::move(other.m_handle))
-                , m_task(std::move(other.m_task))
-                , m_counter(std::move(other.m_counter))
+            template< typename F >
+            explicit basic_task(F func) requires (!StoreCounter)
+                : m_frame(make_task_frame(std::move(func)).m_coroutine)
             {
-                other.m_handle = task_handle();
             }
 
-            task& operator=(const task&) = delete;
-            task& operator=(task&& other)
+            // -----------------------------------------------------------------------------
+
+
+            basic_task(const basic_task&) = delete;
+            basic_task(basic_task&& other)
+                : m_frame(other.m_frame)
             {
-                m_handle = std::move(other.m_handle);
-                m_task = std::move(other.m_task);
-                m_counter = std::move(other.m_counter);
+                other.m_frame = nullptr;
 
-                other.m_handle = task_handle();
+                if constexpr (StoreCounter)
+                {
+                    m_counter = other.m_counter;
+                    other.m_counter = nullptr;
+                }
+            }
+
+            basic_task& operator=(const basic_task&) = delete;
+            basic_task& operator=(basic_task&& other)
+            {
+                if (this != &other)
+                {
+                    if (m_frame)
+                    {
+                        m_frame.destroy();
+                    }
+
+                    m_frame = other.m_frame;
+                    other.m_frame = nullptr;
+
+                    if constexpr (StoreCounter)
+                    {
+                        m_counter = other.m_counter;
+                        other.m_counter = nullptr;
+                    }
+                }
 
                 return *this;
             }
@@ -73,47 +234,40 @@ namespace ctl
 
             bool is_valid() const
             {
-                return static_cast<bool>(m_task);
+                return !!m_frame;
             }
 
             // -----------------------------------------------------------------------------
 
             bool complete() const
             {
-                return m_handle.valid() && m_handle.complete();
+                return m_frame && m_frame.done();
             }
 
             // -----------------------------------------------------------------------------
 
             bool waiting() const
             {
-                return m_handle.valid() && m_handle.waiting();
+                return m_frame && !m_frame.done() && m_frame.promise().waiting();
             }
 
             // -----------------------------------------------------------------------------
 
             const_task_counter_ptr get_waiting_counter() const
             {
-                return m_handle.get_counter();
+                return m_frame.promise().get_waiting_counter();
             }
 
             // -----------------------------------------------------------------------------
 
             void run()
             {
-                if (m_handle.valid() && !m_handle.complete())
-                {
-                    m_handle.resume();
-                }
-                else
-                {
-                    m_handle = m_task();
-                }
+                m_frame.resume();
             }
 
             // -----------------------------------------------------------------------------
 
-            task_counter_ptr get_counter() const
+            task_counter* get_counter() const
             {
                 return m_counter;
             }
@@ -123,14 +277,18 @@ namespace ctl
 
         private:
 
-            task_handle m_handle;
-            task_function m_task;
-            task_counter_ptr m_counter;
+            std::coroutine_handle<task_frame::promise_type> m_frame;
         };
+
+        // -----------------------------------------------------------------------------
+
+        using task = basic_task<true>;
+
+        static_assert(sizeof(basic_task<true>) <= 2 * sizeof(void*), "Queued task records should stay two pointers wide");
+        static_assert(sizeof(basic_task<false>) == sizeof(void*), "Records without counters should be a single handle");
     }
 }
 
 // -----------------------------------------------------------------------------
 // -----------------------------------------------------------------------------
 // -----------------------------------------------------------------------------
-
@@ -1,14 +1,32 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
 #include <list>
 #include <map>
 #include <mutex>
 #include <queue>
+#include <thread>
 #include <vector>
 
+#include <ctl/blocking_pool.h>
+#include <ctl/ring_buffer.h>
 #include <ctl/task_counter.h>
 #include <ctl/task.h>
+#include <ctl/task_queue_context.h>
+#include <ctl/task_queue_policies.h>
 #include <ctl/sleeping_task.h>
+#include <ctl/worker_pool.h>
+
+// -----------------------------------------------------------------------------
+
+// Lets members whose policy compiles them out take no space in the queue.
+#if defined(_MSC_VER)
+#define CTL_NO_UNIQUE_ADDRESS [[msvc::no_unique_address]]
+#else
+#define CTL_NO_UNIQUE_ADDRESS [[no_unique_address]]
+#endif
 
 // -----------------------------------------------------------------------------
 
@@ -16,10 +34,45 @@ namespace ctl
 {
     namespace impl
     {
-        class task;
-        class sleeping_task;
+        struct no_sleeping_tasks
+        {
+        };
+
+        // -----------------------------------------------------------------------------
+
+        // The threads a queue owns and the state used to scale them, all protected by
+        // the queue's lock apart from abort, which workers poll between tasks. Parked
+        // workers always sleep on a condition variable, whatever the wake policy, so
+        // that they cost nothing until they are activated.
+        struct worker_threads
+        {
+            std::atomic<bool> abort = false;
+            std::condition_variable waitForActivation;
+            std::vector<std::thread> threads;
+            worker_pool_config config;
+            worker_pool_stats stats;
+            size_t count = 0;
+            size_t reservedActive = 0;
+            size_t reservedParked = 0;
+            size_t pendingActivations = 0;
+            size_t overloadedSamples = 0;
+        };
+
+        // -----------------------------------------------------------------------------
+
+        struct no_worker_threads
+        {
+        };
+
+        // -----------------------------------------------------------------------------
+
+        struct no_blocking_pool
+        {
+        };
     }
 
+    // -----------------------------------------------------------------------------
+
     struct suspend_until
     {
 
@@ -51,39 +104,138 @@ namespace ctl
 
     // -----------------------------------------------------------------------------
 
-    class task_queue final
+    // A queue of coroutine tasks run by worker threads. Its structure, locking, counter
+    // support, callable storage and instrumentation are chosen at compile time through
+    // Policies (see task_queue_policies.h), and anything a policy leaves out is not
+    // compiled in. task_queue is the general purpose configuration.
+    template< typename Policies >
+    class basic_task_queue final : private impl::task_queue_context
     {
+        using queue_policy = typename Policies::queue_policy;
+        using wake_policy = typename Policies::wake_policy;
+        using counter_policy = typename Policies::counter_policy;
+        using storage_policy = typename Policies::storage_policy;
+        using instrumentation_policy = typename Policies::instrumentation_policy;
+
+        using mutex_type = typename wake_policy::mutex_type;
+        using task_type = impl::basic_task<counter_policy::enabled>;
+        using sleeping_task_list = std::conditional_t<counter_policy::track_sleeping, std::vector<ctl::impl::sleeping_task>, impl::no_sleeping_tasks>;
+        using worker_thread_state = std::conditional_t<wake_policy::threaded, impl::worker_threads, impl::no_worker_threads>;
+        using blocking_pool_type = std::conditional_t<wake_policy::threaded, blocking_pool, impl::no_blocking_pool>;
+
     public:
 
-        task_queue()
+        using policies = Policies;
+
+        // -----------------------------------------------------------------------------
+
+        basic_task_queue()
             : m_mutex()
+            , m_waitForTasks()
             , m_queue()
-            , m_abort(false)
+            , m_sleepingTasks()
+            , m_instrumentation()
+            , m_workers()
+            , m_blockingPool()
         {
         }
 
-        ~task_queue() = default;
+        ~basic_task_queue()
+        {
+            if constexpr (wake_policy::threaded)
+            {
+                stop_workers();
+            }
+        }
 
         // -----------------------------------------------------------------------------
 
-        task_queue(task_queue&&) = default;
-        task_queue& operator=(task_queue&&) = default;
-        task_queue(const task_queue&) = delete;
-        task_queue& operator=(const task_queue&) = delete;
+        basic_task_queue(basic_task_queue&&) = default;
+        basic_task_queue& operator=(basic_task_queue&&) = default;
+        basic_task_queue(const basic_task_queue&) = delete;
+        basic_task_queue& operator=(const basic_task_queue&) = delete;
 
         // -----------------------------------------------------------------------------
 
         void initialize_thread()
         {
+            static_assert(wake_policy::threaded, "This task queue was configured for a single thread");
+
             run_task_thread();
         }
 
         // -----------------------------------------------------------------------------
 
+        // Runs queued tasks on the calling thread until none of them can make progress.
+        // Tasks which suspend without waiting on a counter count as progress.
+        void run_until_idle()
+        {
+            impl::scoped_task_queue_context context(this);
+
+            size_t idleAttempts = 0;
+
+            while (idleAttempts <= queued_task_count())
+            {
+                idleAttempts = run_next_available_task() ? 0 : idleAttempts + 1;
+            }
+        }
+
+        // -----------------------------------------------------------------------------
+
+        // Starts threads owned by the queue. Between config.minWorkers and
+        // config.maxWorkers of them are kept active depending on load; the rest park
+        // until they are needed. Threads running initialize_thread() are not scaled.
+        void start_workers(const worker_pool_config& config)
+        {
+            static_assert(wake_policy::threaded, "This task queue was configured for a single thread");
+
+            {
+                std::lock_guard<mutex_type> lock(m_mutex);
+
+                m_workers.config = config;
+                m_workers.config.maxWorkers = std::max<size_t>(m_workers.config.maxWorkers, 1);
+                m_workers.config.minWorkers = std::min(std::max<size_t>(m_workers.config.minWorkers, 1), m_workers.config.maxWorkers);
+
+                while (m_workers.count < m_workers.config.minWorkers)
+                {
+                    reserve_worker(false);
+                }
+
+                reserve_standby_workers();
+            }
+
+            start_reserved_workers();
+        }
+
+        // -----------------------------------------------------------------------------
+
+        worker_pool_stats get_worker_stats() const
+        {
+            static_assert(wake_policy::threaded, "This task queue was configured for a single thread");
+
+            std::lock_guard<mutex_type> lock(m_mutex);
+            return m_workers.stats;
+        }
+
+        // -----------------------------------------------------------------------------
+
+        instrumentation_policy get_instrumentation() const
+        {
+            std::lock_guard<mutex_type> lock(m_mutex);
+            return m_instrumentation;
+        }
+
+        // -----------------------------------------------------------------------------
+
         void abort()
         {
-            m_abort = true;
+            static_assert(wake_policy::threaded, "This task queue was configured for a single thread");
+
+            std::lock_guard<mutex_type> lock(m_mutex);
+
+            m_workers.abort = true;
             m_waitForTasks.notify_all();
+            m_workers.waitForActivation.notify_all();
         }
 
         // -----------------------------------------------------------------------------
@@ -91,6 +243,8 @@ namespace ctl
         template< typename T >
         task_counter_ptr push_waitable_tasks(const T& taskCollection)
         {
+            static_assert(counter_policy::enabled, "This task queue was configured without counters");
+
             auto counter = std::make_shared<task_counter>(taskCollection.size());
 
             push_tasks_impl(taskCollection, counter);
@@ -103,7 +257,14 @@ namespace ctl
         template< typename T >
         void push_tasks(const T& taskCollection)
         {
-            push_tasks_impl(taskCollection, nullptr);
+            if constexpr (counter_policy::enabled)
+            {
+                push_tasks_impl(taskCollection, nullptr);
+            }
+            else
+            {
+                push_tasks_impl(taskCollection);
+            }
         }
 
         // -----------------------------------------------------------------------------
@@ -111,6 +272,8 @@ namespace ctl
         template< typename T >
         task_counter_ptr push_waitable_task(T task)
         {
+            static_assert(counter_policy::enabled, "This task queue was configured without counters");
+
             auto counter = std::make_shared<task_counter>(1u);
 
             push_task_impl(std::move(task), counter);
@@ -123,7 +286,70 @@ namespace ctl
         template< typename T >
         void push_task(T task)
         {
-            push_task_impl(std::move(task), nullptr);
+            if constexpr (counter_policy::enabled)
+            {
+                push_task_impl(std::move(task), nullptr);
+            }
+            else
+            {
+                push_task_impl(std::move(task));
+            }
+        }
+
+        // -----------------------------------------------------------------------------
+
+        // Runs a plain function on the blocking pool rather than on a worker. The
+        // returned counter reaches zero when it finishes, waking anything suspended
+        // on it. An exception thrown by the function is discarded; use run_blocking
+        // to get it back.
+        template< typename T >
+        task_counter_ptr push_waitable_blocking_task(T task)
+        {
+            static_assert(counter_policy::enabled, "This task queue was configured without counters");
+            static_assert(wake_policy::threaded, "This task queue was configured for a single thread");
+
+            return push_blocking_work(std::move(task));
+        }
+
+        // -----------------------------------------------------------------------------
+
+        blocking_pool& get_blocking_pool()
+        {
+            static_assert(wake_policy::threaded, "This task queue was configured for a single thread");
+
+            return m_blockingPool;
+        }
+
+        // -----------------------------------------------------------------------------
+
+        // Counts down a counter on behalf of work which ran outside the queue, waking
+        // any tasks suspended on it once it reaches zero.
+        void release_counter(task_counter* counter) override
+        {
+            if (counter && counter->fetch_sub(1) == 1)
+            {
+                std::lock_guard<mutex_type> lock(m_mutex);
+
+                counter->notify_all();
+
+                if constexpr (counter_policy::track_sleeping)
+                {
+                    for (auto iter = m_sleepingTasks.begin(); iter != m_sleepingTasks.end(); )
+                    {
+                        if (iter->get_counter().get() == counter)
+                        {
+                            queue_policy::requeue(m_queue, std::move(iter->get_task()));
+                            iter = m_sleepingTasks.erase(iter);
+                            m_instrumentation.on_wake();
+                            m_waitForTasks.notify_all();
+                        }
+                        else
+                        {
+                            ++iter;
+                        }
+                    }
+                }
+            }
         }
 
         // -----------------------------------------------------------------------------
@@ -131,129 +357,514 @@ namespace ctl
 
     private:
 
-        void run_task_thread()
+        // Tasks suspended on the returned counter are polled or tracked like any
+        // other, so offloading works with every counter policy. A single threaded
+        // queue has no pool, so run_blocking runs the work inline instead.
+        task_counter_ptr push_blocking_work([[maybe_unused]] std::function<void()> work) override
         {
-            while (!m_abort)
+            if constexpr (!wake_policy::threaded)
             {
-                run_next_available_task();
-                wait_for_tasks();
+                return nullptr;
+            }
+            else
+            {
+                auto counter = std::make_shared<task_counter>(1u);
+
+                m_blockingPool.push([this, work = std::move(work), counter]()
+                {
+                    // Letting the exception escape would end the blocking thread without
+                    // releasing the counter, leaving its waiters asleep for good.
+                    try
+                    {
+                        work();
+                    }
+                    catch (...)
+                    {
+                    }
+
+                    release_counter(counter.get());
+                });
+
+                return counter;
             }
         }
 
         // -----------------------------------------------------------------------------
 
-        void wait_for_tasks()
+        // Called with the lock held. The worker is counted straight away, but its thread
+        // is only created by start_reserved_workers once the lock has been released.
+        void reserve_worker(const bool parked)
         {
-            std::unique_lock<std::mutex> lk(m_mutex);
+            ++m_workers.count;
+            ++m_workers.stats.threadsStarted;
 
-            if (m_queue.empty())
+            if (parked)
+            {
+                ++m_workers.reservedParked;
+                ++m_workers.stats.parkedWorkers;
+            }
+            else
             {
-                m_waitForTasks.wait(lk);
+                ++m_workers.reservedActive;
+                ++m_workers.stats.activeWorkers;
             }
         }
 
         // -----------------------------------------------------------------------------
 
-        void run_next_available_task()
+        void reserve_standby_workers()
         {
-            impl::task task;
+            while (m_workers.stats.parkedWorkers - m_workers.pendingActivations < m_workers.config.standbyWorkers
+                && m_workers.count < m_workers.config.maxWorkers)
             {
-                std::lock_guard<std::mutex> lock(m_mutex);
-                if (!m_queue.empty())
+                reserve_worker(true);
+            }
+        }
+
+        // -----------------------------------------------------------------------------
+
+        // Creates the threads for reserved workers. Creating a thread is slow, so it is
+        // never done with the lock held, where it would stall every worker and pusher.
+        void start_reserved_workers()
+        {
+            std::unique_lock<mutex_type> lock(m_mutex);
+
+            while (!m_workers.abort && m_workers.reservedActive + m_workers.reservedParked > 0)
+            {
+                const bool parked = m_workers.reservedActive == 0;
+                --(parked ? m_workers.reservedParked : m_workers.reservedActive);
+
+                lock.unlock();
+                std::thread worker([this, parked]() { run_worker_thread(parked); });
+                lock.lock();
+
+                if (m_workers.abort)
                 {
-                    task = std::move(m_queue.front());
-                    m_queue.erase(m_queue.begin());
+                    // stop_workers has already taken the list, so the thread is joined here.
+                    lock.unlock();
+                    worker.join();
+                    return;
                 }
+
+                m_workers.threads.push_back(std::move(worker));
             }
+        }
 
-            if (task.is_valid())
+        // -----------------------------------------------------------------------------
+
+        // Tasks still running may push more work while the workers are joined, so the
+        // list is taken under the lock and balance_workers stops starting threads once
+        // the queue is aborted.
+        void stop_workers()
+        {
+            std::vector<std::thread> workers;
             {
-                task.run();
+                std::lock_guard<mutex_type> lock(m_mutex);
 
-                if (!task.complete())
+                if (m_workers.count == 0)
                 {
-                    if (task.waiting())
-                    {
-                        std::lock_guard<std::mutex> lock(m_mutex);
-                        m_sleepingTasks.emplace_back(std::move(task));
-                    }
-                    else
+                    return;
+                }
+
+                m_workers.abort = true;
+                m_waitForTasks.notify_all();
+                m_workers.waitForActivation.notify_all();
+
+                workers.swap(m_workers.threads);
+            }
+
+            for (std::thread& worker : workers)
+            {
+                worker.join();
+            }
+        }
+
+        // -----------------------------------------------------------------------------
+
+        // Called with the lock held whenever tasks are added or taken by a worker, with
+        // the number of tasks just added. Once the queue has been deeper than the active
+        // workers can keep up with for several calls in a row, or at once if a single
+        // push was that deep by itself, enough workers are activated to bring the depth
+        // per worker back down: parked workers first, then new threads. Woken workers
+        // start any replacement standby threads themselves; if this reserved any new
+        // threads it returns true, and the caller must call start_reserved_workers once
+        // it has released the lock.
+        bool balance_workers(const size_t added)
+        {
+            if (m_workers.abort || m_workers.count == 0)
+            {
+                return false;
+            }
+
+            const size_t depthPerWorker = std::max<size_t>(m_workers.config.growQueueDepth, 1);
+            const size_t activeWorkers = m_workers.stats.activeWorkers + m_workers.pendingActivations;
+
+            if (m_queue.size() <= depthPerWorker * activeWorkers)
+            {
+                m_workers.overloadedSamples = 0;
+                return false;
+            }
+
+            if (activeWorkers >= m_workers.config.maxWorkers)
+            {
+                return false;
+            }
+
+            const bool burst = added > depthPerWorker * activeWorkers;
+
+            if (!burst && ++m_workers.overloadedSamples < m_workers.config.growSamples)
+            {
+                return false;
+            }
+
+            m_workers.overloadedSamples = 0;
+
+            const size_t wantedWorkers = std::min((m_queue.size() + depthPerWorker - 1) / depthPerWorker, m_workers.config.maxWorkers);
+            const size_t activations = std::min(wantedWorkers - activeWorkers, m_workers.stats.parkedWorkers - m_workers.pendingActivations);
+
+            for (size_t i = 0; i < activations; ++i)
+            {
+                ++m_workers.pendingActivations;
+                m_workers.waitForActivation.notify_one();
+            }
+
+            while (m_workers.count < m_workers.config.maxWorkers && m_workers.stats.activeWorkers + m_workers.pendingActivations < wantedWorkers)
+            {
+                reserve_worker(false);
+            }
+
+            reserve_standby_workers();
+
+            return m_workers.reservedActive + m_workers.reservedParked > 0;
+        }
+
+        // -----------------------------------------------------------------------------
+
+        // Parks the calling worker until balance_workers activates it. Returns false
+        // if the queue was aborted instead.
+        bool park_worker(std::unique_lock<mutex_type>& lock)
+        {
+            m_workers.waitForActivation.wait(lock, [this]() { return m_workers.abort || m_workers.pendingActivations > 0; });
+
+            --m_workers.stats.parkedWorkers;
+
+            if (m_workers.abort)
+            {
+                return false;
+            }
+
+            --m_workers.pendingActivations;
+            ++m_workers.stats.activeWorkers;
+            ++m_workers.stats.activations;
+
+            if (m_workers.reservedActive + m_workers.reservedParked > 0)
+            {
+                lock.unlock();
+                start_reserved_workers();
+            }
+
+            return true;
+        }
+
+        // -----------------------------------------------------------------------------
+
+        // Called by an active worker which has been idle for a full shrinkIdleTime.
+        // Returns false if the queue was aborted while it was parked.
+        bool park_idle_worker()
+        {
+            std::unique_lock<mutex_type> lock(m_mutex);
+
+            if (m_workers.abort || !m_queue.empty() || m_workers.stats.activeWorkers <= m_workers.config.minWorkers)
+            {
+                return true;
+            }
+
+            --m_workers.stats.activeWorkers;
+            ++m_workers.stats.parkedWorkers;
+            ++m_workers.stats.parks;
+
+            return park_worker(lock);
+        }
+
+        // -----------------------------------------------------------------------------
+
+        void run_worker_thread(const bool parked)
+        {
+            impl::scoped_task_queue_context context(this);
+
+            bool active = true;
+
+            if (parked)
+            {
+                std::unique_lock<mutex_type> lock(m_mutex);
+                active = park_worker(lock);
+            }
+
+            size_t attempts = 0;
+            size_t failures = 0;
+
+            while (active && !m_workers.abort)
+            {
+                ++attempts;
+
+                if (run_next_available_task())
+                {
+                    continue;
+                }
+
+                ++failures;
+
+                if (wait_for_tasks(m_workers.config.shrinkIdleTime))
+                {
+                    continue;
+                }
+
+                const bool idle = failures * 100 >= attempts * m_workers.config.shrinkFailurePercent;
+
+                attempts = 0;
+                failures = 0;
+
+                if (idle)
+                {
+                    active = park_idle_worker();
+                }
+            }
+
+            {
+                std::lock_guard<mutex_type> lock(m_mutex);
+
+                if (active)
+                {
+                    --m_workers.stats.activeWorkers;
+                }
+            }
+        }
+
+        // -----------------------------------------------------------------------------
+
+        void run_task_thread()
+        {
+            impl::scoped_task_queue_context context(this);
+
+            while (!m_workers.abort)
+            {
+                run_next_available_task();
+                wait_for_tasks();
+            }
+        }
+
+        // -----------------------------------------------------------------------------
+
+        void wait_for_tasks()
+        {
+            std::unique_lock<mutex_type> lk(m_mutex);
+
+            m_waitForTasks.wait(lk, [this]() { return m_workers.abort || !m_queue.empty(); });
+        }
+
+        // -----------------------------------------------------------------------------
+
+        // Returns false if the timeout passed without any task becoming available.
+        bool wait_for_tasks(const std::chrono::microseconds timeout)
+        {
+            std::unique_lock<mutex_type> lk(m_mutex);
+
+            return m_waitForTasks.wait_for(lk, timeout, [this]() { return m_workers.abort || !m_queue.empty(); });
+        }
+
+        // -----------------------------------------------------------------------------
+
+        bool run_next_available_task()
+        {
+            task_type task;
+            bool startWorkers = false;
+            {
+                std::lock_guard<mutex_type> lock(m_mutex);
+                if (!m_queue.empty())
+                {
+                    task = queue_policy::pop_next(m_queue);
+
+                    // Without a sleeping list, tasks waiting on a counter stay queued
+                    // and are skipped until it is released.
+                    if (!counter_policy::track_sleeping && task.waiting())
                     {
-                        std::lock_guard<std::mutex> lock(m_mutex);
-                        m_queue.push_back(std::move(task));
+                        queue_policy::requeue(m_queue, std::move(task));
                     }
+                }
+
+                m_instrumentation.on_dequeue(task.is_valid());
 
-                    m_waitForTasks.notify_all();
+                // Dequeues sample the depth too, so that a queue which stays deep keeps
+                // growing while nothing is being pushed.
+                if constexpr (wake_policy::threaded)
+                {
+                    startWorkers = task.is_valid() && balance_workers(0);
                 }
-                else
+            }
+
+            if constexpr (wake_policy::threaded)
+            {
+                if (startWorkers)
                 {
-                    auto counter = task.get_counter();
+                    start_reserved_workers();
+                }
+            }
 
-                    if (counter && counter->fetch_sub(1) == 1)
-                    {
-                        std::lock_guard< std::mutex > lock(m_mutex);
+            if (!task.is_valid())
+            {
+                return false;
+            }
 
-                        counter->notify_all();
+            task.run();
 
-                        for (auto iter = m_sleepingTasks.begin(); iter != m_sleepingTasks.end(); )
-                        {
-                            if (iter->get_task().get_waiting_counter() == counter)
-                            {
-                                m_queue.emplace_back(std::move(iter->get_task()));
-                                iter = m_sleepingTasks.erase(iter);
-                                m_waitForTasks.notify_all();
-                            }
-                            else
-                            {
-                                ++iter;
-                            }
-                        }
-                    }
+            if (!task.complete())
+            {
+                {
+                    // The counter may be released from outside the queue, so it is
+                    // checked under the lock that release_counter takes.
+                    std::lock_guard<mutex_type> lock(m_mutex);
+
+                    requeue_task(std::move(task));
                 }
+
+                m_waitForTasks.notify_all();
+            }
+            else
+            {
+                release_counter(task.get_counter());
             }
+
+            return true;
         }
 
         // -----------------------------------------------------------------------------
 
-        template< typename T >
-        void push_tasks_impl(const T& taskCollection, task_counter_ptr counter)
+        // Called with the lock held for a task which suspended before completing.
+        void requeue_task(task_type&& task)
+        {
+            if constexpr (counter_policy::track_sleeping)
+            {
+                if (task.waiting())
+                {
+                    m_sleepingTasks.emplace_back(std::move(task));
+                    m_instrumentation.on_sleep();
+                    return;
+                }
+            }
+
+            queue_policy::requeue(m_queue, std::move(task));
+        }
+
+        // -----------------------------------------------------------------------------
+
+        size_t queued_task_count() const
         {
+            std::lock_guard<mutex_type> lock(m_mutex);
+            return m_queue.size();
+        }
+
+        // -----------------------------------------------------------------------------
+
+        // Counter is empty when the queue has no counters, so that records are
+        // created without one.
+        template< typename T, typename... Counter >
+        void push_tasks_impl(const T& taskCollection, const Counter&... counter)
+        {
+            // Creating a record allocates its frame and copies the callable, so all of
+            // them are created before the lock is taken, as push_task_impl does.
+            std::vector<task_type> queuedTasks;
+            queuedTasks.reserve(taskCollection.size());
+
+            for (auto& task : taskCollection)
             {
-                std::lock_guard<std::mutex> lock(m_mutex);
+                queuedTasks.emplace_back(storage_policy::store(task), counter...);
+            }
 
-                for (auto& task : taskCollection)
+            bool startWorkers = false;
+            {
+                std::lock_guard<mutex_type> lock(m_mutex);
+
+                m_queue.reserve(m_queue.size() + queuedTasks.size());
+
+                for (task_type& queuedTask : queuedTasks)
+                {
+                    m_queue.push_back(std::move(queuedTask));
+                }
+
+                m_instrumentation.on_push(taskCollection.size());
+
+                if constexpr (wake_policy::threaded)
                 {
-                    m_queue.emplace_back(task, counter);
+                    startWorkers = balance_workers(queuedTasks.size());
                 }
             }
 
             m_waitForTasks.notify_all();
+
+            if constexpr (wake_policy::threaded)
+            {
+                if (startWorkers)
+                {
+                    start_reserved_workers();
+                }
+            }
         }
 
         // -----------------------------------------------------------------------------
 
-        template< typename T >
-        void push_task_impl(T task, task_counter_ptr counter)
+        template< typename T, typename... Counter >
+        void push_task_impl(T task, Counter... counter)
         {
+            task_type queuedTask(storage_policy::store(std::move(task)), std::move(counter)...);
+            bool startWorkers = false;
+
             {
-                std::lock_guard<std::mutex> lock(m_mutex);
-                m_queue.emplace_back(std::move(task), std::move(counter));
+                std::lock_guard<mutex_type> lock(m_mutex);
+                m_queue.push_back(std::move(queuedTask));
+                m_instrumentation.on_push(1);
+
+                if constexpr (wake_policy::threaded)
+                {
+                    startWorkers = balance_workers(1);
+                }
             }
 
             m_waitForTasks.notify_all();
+
+            if constexpr (wake_policy::threaded)
+            {
+                if (startWorkers)
+                {
+                    start_reserved_workers();
+                }
+            }
         }
 
         // -----------------------------------------------------------------------------
 
-        std::atomic<bool> m_abort;
-        std::mutex m_mutex;
-        std::condition_variable m_waitForTasks;
+        CTL_NO_UNIQUE_ADDRESS mutable mutex_type m_mutex;
+        CTL_NO_UNIQUE_ADDRESS typename wake_policy::waiter m_waitForTasks;
+
+        // -----------------------------------------------------------------------------
+
+        typename queue_policy::template container<task_type> m_queue;
+        CTL_NO_UNIQUE_ADDRESS sleeping_task_list m_sleepingTasks;
+        CTL_NO_UNIQUE_ADDRESS instrumentation_policy m_instrumentation;
+
+        // -----------------------------------------------------------------------------
+
+        CTL_NO_UNIQUE_ADDRESS worker_thread_state m_workers;
 
         // -----------------------------------------------------------------------------
 
-        std::vector<ctl::impl::task> m_queue;
-        std::vector<ctl::impl::sleeping_task> m_sleepingTasks;
+        // Declared last so that blocking threads, which release counters on this
+        // queue, have all exited before the rest of the queue is destroyed.
+        CTL_NO_UNIQUE_ADDRESS blocking_pool_type m_blockingPool;
     };
+
+    // -----------------------------------------------------------------------------
+
+    using task_queue = basic_task_queue<default_task_queue_policies>;
 }
 
 // -----------------------------------------------------------------------------
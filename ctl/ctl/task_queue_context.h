@@ -0,0 +1,70 @@
+#pragma once
+
+#include <functional>
+
+#include <ctl/task_counter.h>
+
+// -----------------------------------------------------------------------------
+
+namespace ctl
+{
+    namespace impl
+    {
+        // What code running inside a task needs from the queue running it, whatever
+        // that queue's policies are. Every basic_task_queue makes itself the current
+        // context on the threads that run its tasks.
+        class task_queue_context
+        {
+        public:
+
+            // Counts the counter down, waking any tasks suspended on it once it reaches zero.
+            virtual void release_counter(task_counter* counter) = 0;
+
+            // Runs work on the queue's blocking pool and returns a counter which is
+            // released once it has finished, or nullptr if the queue has no blocking pool.
+            virtual task_counter_ptr push_blocking_work(std::function<void()> work) = 0;
+
+        protected:
+
+            ~task_queue_context() = default;
+        };
+
+        // -----------------------------------------------------------------------------
+
+        inline task_queue_context*& current_task_queue_context()
+        {
+            thread_local task_queue_context* context = nullptr;
+            return context;
+        }
+
+        // -----------------------------------------------------------------------------
+
+        // Makes a queue the current context until the end of the scope.
+        class scoped_task_queue_context
+        {
+        public:
+
+            explicit scoped_task_queue_context(task_queue_context* context)
+                : m_previousContext(current_task_queue_context())
+            {
+                current_task_queue_context() = context;
+            }
+
+            ~scoped_task_queue_context()
+            {
+                current_task_queue_context() = m_previousContext;
+            }
+
+            scoped_task_queue_context(const scoped_task_queue_context&) = delete;
+            scoped_task_queue_context& operator=(const scoped_task_queue_context&) = delete;
+
+        private:
+
+            task_queue_context* m_previousContext;
+        };
+    }
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
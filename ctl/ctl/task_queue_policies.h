@@ -0,0 +1,296 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include <ctl/ring_buffer.h>
+#include <ctl/task.h>
+
+// -----------------------------------------------------------------------------
+
+namespace ctl
+{
+    namespace impl
+    {
+        struct null_mutex
+        {
+            void lock() {}
+            bool try_lock() { return true; }
+            void unlock() {}
+        };
+    }
+
+    // -----------------------------------------------------------------------------
+    // Queue structure: the container queued tasks are kept in and which one runs next.
+    // -----------------------------------------------------------------------------
+
+    // Tasks run in the order they were pushed.
+    struct fifo_queue
+    {
+        template< typename T >
+        using container = impl::ring_buffer<T>;
+
+        template< typename T >
+        static T pop_next(container<T>& items)
+        {
+            return items.pop_front();
+        }
+
+        template< typename T >
+        static void requeue(container<T>& items, T&& item)
+        {
+            items.push_back(std::move(item));
+        }
+    };
+
+    // -----------------------------------------------------------------------------
+
+    // The most recently pushed task runs next, which keeps the data it was pushed
+    // with warm in cache. Tasks which suspend go to the cold end of the ring so that
+    // they cannot starve the rest, without shifting the tasks already queued.
+    struct lifo_queue
+    {
+        template< typename T >
+        using container = impl::ring_buffer<T>;
+
+        template< typename T >
+        static T pop_next(container<T>& items)
+        {
+            return items.pop_back();
+        }
+
+        template< typename T >
+        static void requeue(container<T>& items, T&& item)
+        {
+            items.push_front(std::move(item));
+        }
+    };
+
+    // -----------------------------------------------------------------------------
+    // Wake strategy: the lock protecting the queue and how idle workers wait for tasks.
+    // -----------------------------------------------------------------------------
+
+    // Idle workers sleep on a condition variable.
+    struct condition_variable_wake
+    {
+        static constexpr bool threaded = true;
+
+        using mutex_type = std::mutex;
+
+        class waiter
+        {
+        public:
+
+            template< typename Predicate >
+            void wait(std::unique_lock<mutex_type>& lock, Predicate predicate)
+            {
+                m_condition.wait(lock, predicate);
+            }
+
+            template< typename Predicate >
+            bool wait_for(std::unique_lock<mutex_type>& lock, const std::chrono::microseconds timeout, Predicate predicate)
+            {
+                return m_condition.wait_for(lock, timeout, predicate);
+            }
+
+            void notify_one() { m_condition.notify_one(); }
+            void notify_all() { m_condition.notify_all(); }
+
+        private:
+
+            std::condition_variable m_condition;
+        };
+    };
+
+    // -----------------------------------------------------------------------------
+
+    // Idle workers yield in a loop instead of sleeping, trading CPU for wake latency.
+    // Pushing never has to notify anyone. Parked workers still sleep.
+    struct spin_wake
+    {
+        static constexpr bool threaded = true;
+
+        using mutex_type = std::mutex;
+
+        class waiter
+        {
+        public:
+
+            template< typename Predicate >
+            void wait(std::unique_lock<mutex_type>& lock, Predicate predicate)
+            {
+                while (!predicate())
+                {
+                    lock.unlock();
+                    std::this_thread::yield();
+                    lock.lock();
+                }
+            }
+
+            template< typename Predicate >
+            bool wait_for(std::unique_lock<mutex_type>& lock, const std::chrono::microseconds timeout, Predicate predicate)
+            {
+                const auto deadline = std::chrono::steady_clock::now() + timeout;
+
+                while (!predicate())
+                {
+                    if (std::chrono::steady_clock::now() >= deadline)
+                    {
+                        return false;
+                    }
+
+                    lock.unlock();
+                    std::this_thread::yield();
+                    lock.lock();
+                }
+
+                return true;
+            }
+
+            void notify_one() {}
+            void notify_all() {}
+        };
+    };
+
+    // -----------------------------------------------------------------------------
+
+    // No locking and no waiting, for a queue which is pushed to and run from a single
+    // thread with run_until_idle(). The queue carries no worker or blocking threads:
+    // start_workers, initialize_thread and strands do not compile with it, and
+    // run_blocking runs its function inline.
+    struct single_thread_wake
+    {
+        static constexpr bool threaded = false;
+
+        using mutex_type = impl::null_mutex;
+
+        class waiter
+        {
+        public:
+
+            template< typename Predicate >
+            void wait(std::unique_lock<mutex_type>&, Predicate)
+            {
+            }
+
+            template< typename Predicate >
+            bool wait_for(std::unique_lock<mutex_type>&, const std::chrono::microseconds, Predicate predicate)
+            {
+                return predicate();
+            }
+
+            void notify_one() {}
+            void notify_all() {}
+        };
+    };
+
+    // -----------------------------------------------------------------------------
+    // Counters: whether tasks can be waited on, and how waiting tasks are tracked.
+    // -----------------------------------------------------------------------------
+
+    // Waitable pushes return counters. Tasks suspended on a counter are moved aside
+    // and only requeued once it reaches zero.
+    struct tracked_counters
+    {
+        static constexpr bool enabled = true;
+        static constexpr bool track_sleeping = true;
+    };
+
+    // -----------------------------------------------------------------------------
+
+    // Waitable pushes return counters. Tasks suspended on a counter stay in the queue
+    // and are skipped until it reaches zero, which avoids the sleeping list when waits
+    // are short.
+    struct polled_counters
+    {
+        static constexpr bool enabled = true;
+        static constexpr bool track_sleeping = false;
+    };
+
+    // -----------------------------------------------------------------------------
+
+    // Tasks cannot be waited on, and queued records carry no counter at all.
+    struct no_counters
+    {
+        static constexpr bool enabled = false;
+        static constexpr bool track_sleeping = false;
+    };
+
+    // -----------------------------------------------------------------------------
+    // Callable storage: what is kept in a task's frame for the pushed callable.
+    // -----------------------------------------------------------------------------
+
+    // The callable is stored as its own type, so pushing a lambda never allocates
+    // beyond the frame. Each callable type instantiates its own frame.
+    struct inline_storage
+    {
+        template< typename F >
+        static F store(F func)
+        {
+            return func;
+        }
+    };
+
+    // -----------------------------------------------------------------------------
+
+    // Every callable is converted to a task_function, so a single frame type is
+    // instantiated for the queue at the cost of type erasure.
+    struct function_storage
+    {
+        template< typename F >
+        static task_function store(F func)
+        {
+            return task_function(std::move(func));
+        }
+    };
+
+    // -----------------------------------------------------------------------------
+    // Instrumentation: counters updated by the queue, always under its lock.
+    // -----------------------------------------------------------------------------
+
+    struct no_instrumentation
+    {
+        void on_push(const size_t) {}
+        void on_dequeue(const bool) {}
+        void on_sleep() {}
+        void on_wake() {}
+    };
+
+    // -----------------------------------------------------------------------------
+
+    struct counting_instrumentation
+    {
+        void on_push(const size_t count) { pushes += count; }
+        void on_dequeue(const bool found) { found ? ++successfulDequeues : ++failedDequeues; }
+        void on_sleep() { ++sleeps; }
+        void on_wake() { ++wakes; }
+
+        size_t pushes = 0;
+        size_t successfulDequeues = 0;
+        size_t failedDequeues = 0;
+        size_t sleeps = 0;
+        size_t wakes = 0;
+    };
+
+    // -----------------------------------------------------------------------------
+
+    template< typename Queue, typename Wake, typename Counters, typename Storage, typename Instrumentation >
+    struct task_queue_policies
+    {
+        using queue_policy = Queue;
+        using wake_policy = Wake;
+        using counter_policy = Counters;
+        using storage_policy = Storage;
+        using instrumentation_policy = Instrumentation;
+    };
+
+    // -----------------------------------------------------------------------------
+
+    using default_task_queue_policies = task_queue_policies<fifo_queue, condition_variable_wake, tracked_counters, inline_storage, counting_instrumentation>;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <chrono>
+#include <thread>
+
+// -----------------------------------------------------------------------------
+
+namespace ctl
+{
+    // How a task_queue scales the workers it owns. Workers beyond the active count
+    // are parked on a condition variable and use no CPU until they are needed.
+    struct worker_pool_config
+    {
+        size_t minWorkers = 1;
+        size_t maxWorkers = std::thread::hardware_concurrency() > 0 ? std::thread::hardware_concurrency() : 1;
+
+        // Parked threads kept started ahead of demand so that a burst can be picked
+        // up by waking a thread rather than creating one.
+        size_t standbyWorkers = 1;
+
+        // Workers are activated once the queue has held more than this many tasks per
+        // active worker for growSamples consecutive pushes or dequeues, or straight
+        // away when a single push adds more than that. As many are activated at once
+        // as it takes to bring the depth back under the limit, parked ones first.
+        size_t growQueueDepth = 2;
+        size_t growSamples = 2;
+
+        // An active worker parks once it has waited this long without finding a task,
+        // provided at least shrinkFailurePercent of its dequeue attempts since it last
+        // checked came up empty.
+        std::chrono::microseconds shrinkIdleTime = std::chrono::milliseconds(20);
+        size_t shrinkFailurePercent = 90;
+    };
+
+    // -----------------------------------------------------------------------------
+
+    struct worker_pool_stats
+    {
+        size_t activeWorkers = 0;
+        size_t parkedWorkers = 0;
+        size_t threadsStarted = 0;
+        size_t activations = 0;
+        size_t parks = 0;
+    };
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
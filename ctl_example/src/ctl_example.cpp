@@ -1,3 +1,6 @@
+#include <ctl/async_generator.h>
+#include <ctl/pipeline.h>
+#include <ctl/run_blocking.h>
 #include <ctl/task_queue.h>
 #include <ctl/task.h>
 
@@ -37,21 +40,23 @@ ctl::task_handle test(ctl::task_queue& taskQueue)
 
 // -----------------------------------------------------------------------------
 
+ctl::task_handle tick(const std::string name, const int index)
+{
+    co_await ctl::run_blocking([]() { std::this_thread::sleep_for(std::chrono::milliseconds(rand() % 500)); });
+
+    std::ostringstream ss; ss << std::this_thread::get_id() << "\t" << name << " " << index << '\n';
+    std::cout << ss.str();
+}
+
+// -----------------------------------------------------------------------------
+
 ctl::const_task_counter_ptr tick_system(const std::string& name, const int number, ctl::task_queue& taskQueue)
 {
     std::vector<ctl::task_function> functions;
 
     for (int i = 0; i < number; ++i)
     {
-        auto func = [=]() -> ctl::task_handle
-        {
-            std::this_thread::sleep_for(std::chrono::milliseconds(rand() % 500));
-            std::ostringstream ss; ss << std::this_thread::get_id() << "\t" << name << " " << i << '\n';
-            std::cout << ss.str(); 
-            co_return;
-        };
-
-        functions.push_back(func);
+        functions.push_back([=]() { return tick(name, i); });
     }
 
     return taskQueue.push_waitable_tasks(functions);
@@ -59,6 +64,29 @@ ctl::const_task_counter_ptr tick_system(const std::string& name, const int numbe
 
 // -----------------------------------------------------------------------------
 
+ctl::async_generator<int> generate_numbers(const int count)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        co_yield i;
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+ctl::const_task_counter_ptr stream_squares(const int count, ctl::task_queue& taskQueue)
+{
+    return ctl::make_pipeline([=]() { return generate_numbers(count); }, 4)
+        .then([](int& number) { return number * number; }, 4)
+        .run(taskQueue, [](int& square)
+        {
+            std::ostringstream ss; ss << std::this_thread::get_id() << "\tSquare " << square << '\n';
+            std::cout << ss.str();
+        });
+}
+
+// -----------------------------------------------------------------------------
+
 ctl::task_handle game_loop(ctl::task_queue& taskQueue)
 {
     ctl::const_task_counter_ptr animation = tick_system("Animation", 10, taskQueue);
@@ -71,6 +99,10 @@ ctl::task_handle game_loop(ctl::task_queue& taskQueue)
 
     co_await ctl::suspend_until(physics);
 
+    ctl::const_task_counter_ptr squares = stream_squares(10, taskQueue);
+
+    co_await ctl::suspend_until(squares);
+
     std::cout << "done\n";
 }
 
@@ -80,9 +112,12 @@ int main()
 {
     ctl::task_queue queue;
 
-    std::thread thread1([&]() { queue.initialize_thread(); });
-    std::thread thread2([&]() { queue.initialize_thread(); });
-    
+    ctl::worker_pool_config config;
+    config.minWorkers = 2;
+    config.maxWorkers = 4;
+
+    queue.start_workers(config);
+
     while (true)
     {
         ctl::const_task_counter_ptr ptr = queue.push_waitable_task([&]() { return game_loop(queue); });
@@ -0,0 +1,132 @@
+#include <CppUnitTest.h>
+#include <ctl/async_generator.h>
+#include <ctl/task_handle.h>
+
+#include <vector>
+
+// -----------------------------------------------------------------------------
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+// -----------------------------------------------------------------------------
+
+namespace ctl_test
+{
+    TEST_CLASS(async_generator)
+    {
+    public:
+
+        struct copy_counter
+        {
+            copy_counter(int& copies)
+                : m_copies(&copies)
+            {
+            }
+
+            copy_counter(const copy_counter& other)
+                : m_copies(other.m_copies)
+            {
+                ++*m_copies;
+            }
+
+            int* m_copies;
+        };
+
+        // -----------------------------------------------------------------------------
+
+        static ctl::async_generator<int> count_to(const int count)
+        {
+            for (int i = 0; i < count; ++i)
+            {
+                co_yield i;
+            }
+        }
+
+        // -----------------------------------------------------------------------------
+
+        static ctl::async_generator<int> doubled(ctl::async_generator<int> source)
+        {
+            for (bool hasValue = co_await source.next(); hasValue; hasValue = co_await source.next())
+            {
+                co_yield source.value() * 2;
+            }
+        }
+
+        // -----------------------------------------------------------------------------
+
+        static ctl::async_generator<copy_counter> yield_counter(int& copies)
+        {
+            copy_counter counter(copies);
+
+            co_yield counter;
+        }
+
+        // -----------------------------------------------------------------------------
+
+        static ctl::task_handle collect(ctl::async_generator<int> generator, std::vector<int>& values)
+        {
+            for (bool hasValue = co_await generator.next(); hasValue; hasValue = co_await generator.next())
+            {
+                values.push_back(generator.value());
+            }
+        }
+
+        // -----------------------------------------------------------------------------
+
+        static ctl::task_handle touch_all(ctl::async_generator<copy_counter> generator)
+        {
+            for (bool hasValue = co_await generator.next(); hasValue; hasValue = co_await generator.next())
+            {
+                generator.value();
+            }
+        }
+
+        // -----------------------------------------------------------------------------
+
+        TEST_METHOD(consumed_to_completion_yields_every_value_in_order)
+        {
+            std::vector<int> values;
+            ctl::task_handle handle = collect(count_to(3), values);
+
+            Assert::IsTrue(handle.complete());
+            Assert::IsTrue(values == std::vector<int>{ 0, 1, 2 });
+        }
+
+        // -----------------------------------------------------------------------------
+
+        TEST_METHOD(empty_generator_yields_nothing)
+        {
+            std::vector<int> values;
+            ctl::task_handle handle = collect(count_to(0), values);
+
+            Assert::IsTrue(handle.complete());
+            Assert::IsTrue(values.empty());
+        }
+
+        // -----------------------------------------------------------------------------
+
+        TEST_METHOD(chained_generator_transforms_every_value)
+        {
+            std::vector<int> values;
+            ctl::task_handle handle = collect(doubled(count_to(3)), values);
+
+            Assert::IsTrue(handle.complete());
+            Assert::IsTrue(values == std::vector<int>{ 0, 2, 4 });
+        }
+
+        // -----------------------------------------------------------------------------
+
+        TEST_METHOD(yielded_value_is_not_copied)
+        {
+            int copies = 0;
+            ctl::task_handle handle = touch_all(yield_counter(copies));
+
+            Assert::IsTrue(handle.complete());
+            Assert::AreEqual(0, copies);
+        }
+    };
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
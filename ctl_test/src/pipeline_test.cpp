@@ -0,0 +1,265 @@
+#include <CppUnitTest.h>
+#include <ctl/async_generator.h>
+#include <ctl/pipeline.h>
+#include <ctl/task_queue.h>
+
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+// -----------------------------------------------------------------------------
+
+namespace ctl_test
+{
+    TEST_CLASS(pipeline)
+    {
+    public:
+
+        struct live_counter
+        {
+            void add()
+            {
+                m_peak = std::max(++m_live, m_peak);
+            }
+
+            int m_live = 0;
+            int m_peak = 0;
+        };
+
+        // -----------------------------------------------------------------------------
+
+        struct live_item
+        {
+            live_item(const int value, live_counter& counter)
+                : m_value(value)
+                , m_counter(&counter)
+            {
+                m_counter->add();
+            }
+
+            live_item(const live_item& other)
+                : m_value(other.m_value)
+                , m_counter(other.m_counter)
+            {
+                m_counter->add();
+            }
+
+            live_item(live_item&& other)
+                : m_value(other.m_value)
+                , m_counter(other.m_counter)
+            {
+                m_counter->add();
+            }
+
+            ~live_item()
+            {
+                --m_counter->m_live;
+            }
+
+            int m_value;
+            live_counter* m_counter;
+        };
+
+        // -----------------------------------------------------------------------------
+
+        static ctl::async_generator<int> count_to(const int count, int* produced = nullptr)
+        {
+            for (int i = 0; i < count; ++i)
+            {
+                if (produced != nullptr)
+                {
+                    ++*produced;
+                }
+
+                co_yield i;
+            }
+        }
+
+        // -----------------------------------------------------------------------------
+
+        static ctl::async_generator<int> count_forever()
+        {
+            for (int i = 0; ; ++i)
+            {
+                co_yield i;
+            }
+        }
+
+        // -----------------------------------------------------------------------------
+
+        static ctl::async_generator<live_item> live_items(const int count, live_counter& counter)
+        {
+            for (int i = 0; i < count; ++i)
+            {
+                co_yield live_item(i, counter);
+            }
+        }
+
+        // -----------------------------------------------------------------------------
+
+        TEST_METHOD(every_item_reaches_the_sink_in_order)
+        {
+            ctl::task_queue queue;
+            std::vector<int> values;
+
+            ctl::task_counter_ptr counter = ctl::make_pipeline([]() { return count_to(1000); }, 4)
+                .then([](int& value) { return value * 2; }, 4)
+                .run(queue, [&values](int& value) { values.push_back(value); });
+
+            queue.run_until_idle();
+
+            Assert::IsTrue(*counter == 0, L"Pipeline should have finished");
+            Assert::AreEqual(size_t(1000), values.size());
+
+            for (int i = 0; i < 1000; ++i)
+            {
+                Assert::AreEqual(i * 2, values[i]);
+            }
+        }
+
+        // -----------------------------------------------------------------------------
+
+        TEST_METHOD(source_never_runs_further_ahead_than_the_buffers_allow)
+        {
+            ctl::task_queue queue;
+            int produced = 0;
+            int consumed = 0;
+            int furthestAhead = 0;
+
+            ctl::task_counter_ptr counter = ctl::make_pipeline([&produced]() { return count_to(1000, &produced); }, 4)
+                .then([](int& value) { return value; }, 4)
+                .run(queue, [&](int&)
+                {
+                    furthestAhead = std::max(furthestAhead, produced - consumed);
+                    ++consumed;
+                });
+
+            queue.run_until_idle();
+
+            Assert::IsTrue(*counter == 0, L"Pipeline should have finished");
+            Assert::AreEqual(1000, consumed);
+
+            // Both buffers full, plus the item each producing side holds while it waits.
+            Assert::IsTrue(furthestAhead <= 4 + 4 + 2, L"Source ran ahead of the sink");
+        }
+
+        // -----------------------------------------------------------------------------
+
+        TEST_METHOD(items_alive_at_once_are_bounded_by_the_buffers)
+        {
+            ctl::task_queue queue;
+            live_counter live;
+            int consumed = 0;
+
+            ctl::task_counter_ptr counter = ctl::make_pipeline([&live]() { return live_items(1000, live); }, 8)
+                .then([](live_item& item) { return live_item(item.m_value + 1, *item.m_counter); }, 8)
+                .run(queue, [&consumed](live_item&) { ++consumed; });
+
+            queue.run_until_idle();
+
+            Assert::IsTrue(*counter == 0, L"Pipeline should have finished");
+            Assert::AreEqual(1000, consumed);
+            Assert::AreEqual(0, live.m_live);
+
+            // Both buffers full, plus the value held on each side of every hand over.
+            Assert::IsTrue(live.m_peak <= 8 + 8 + 6, L"Items should not accumulate between stages");
+        }
+
+        // -----------------------------------------------------------------------------
+
+        TEST_METHOD(stage_waiting_for_input_sleeps_instead_of_polling)
+        {
+            ctl::task_queue queue;
+
+            ctl::worker_pool_config config;
+            config.minWorkers = 2;
+            config.maxWorkers = 2;
+            config.standbyWorkers = 0;
+
+            queue.start_workers(config);
+
+            int consumed = 0;
+
+            ctl::task_counter_ptr counter = ctl::make_pipeline([]() { return count_to(5); })
+                .then([](int& value)
+                {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                    return value;
+                })
+                .run(queue, [&consumed](int&) { ++consumed; });
+
+            while (*counter > 0)
+            {
+                std::this_thread::yield();
+            }
+
+            const auto instrumentation = queue.get_instrumentation();
+
+            Assert::AreEqual(5, consumed);
+            Assert::IsTrue(instrumentation.successfulDequeues + instrumentation.failedDequeues < 1000, L"Waiting stages should not be requeued while they wait");
+        }
+
+        // -----------------------------------------------------------------------------
+
+        TEST_METHOD(exception_in_a_stage_stops_the_pipeline_and_reaches_the_error_handler)
+        {
+            ctl::task_queue queue;
+            std::vector<int> values;
+            int errors = 0;
+
+            ctl::task_counter_ptr counter = ctl::make_pipeline([]() { return count_forever(); }, 4)
+                .then([](int& value)
+                {
+                    if (value == 10)
+                    {
+                        throw std::runtime_error("stage failed");
+                    }
+
+                    return value;
+                }, 4)
+                .run(queue, [&values](int& value) { values.push_back(value); }, [&errors](std::exception_ptr error)
+                {
+                    ++errors;
+                    Assert::IsTrue(!!error);
+                });
+
+            queue.run_until_idle();
+
+            Assert::IsTrue(*counter == 0, L"Every stage should have stopped");
+            Assert::AreEqual(1, errors);
+            Assert::AreEqual(size_t(10), values.size());
+        }
+
+        // -----------------------------------------------------------------------------
+
+        TEST_METHOD(exception_in_the_sink_stops_an_endless_source)
+        {
+            ctl::task_queue queue;
+            int errors = 0;
+
+            ctl::task_counter_ptr counter = ctl::make_pipeline([]() { return count_forever(); }, 4)
+                .run(queue, [](int& value)
+                {
+                    if (value == 5)
+                    {
+                        throw std::runtime_error("sink failed");
+                    }
+                }, [&errors](std::exception_ptr) { ++errors; });
+
+            queue.run_until_idle();
+
+            Assert::IsTrue(*counter == 0, L"Every stage should have stopped");
+            Assert::AreEqual(1, errors);
+        }
+    };
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
@@ -0,0 +1,232 @@
+#include <CppUnitTest.h>
+#include <ctl/run_blocking.h>
+#include <ctl/task_queue.h>
+#include <ctl/task_queue_policies.h>
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+// -----------------------------------------------------------------------------
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+// -----------------------------------------------------------------------------
+
+namespace ctl_test
+{
+    TEST_CLASS(run_blocking)
+    {
+    public:
+
+        using uninstrumented_task_queue = ctl::basic_task_queue<ctl::task_queue_policies<ctl::fifo_queue, ctl::condition_variable_wake, ctl::tracked_counters, ctl::inline_storage, ctl::no_instrumentation>>;
+
+        // -----------------------------------------------------------------------------
+
+        static ctl::task_handle store_result(int& result)
+        {
+            result = co_await ctl::run_blocking([]() { return 42; });
+        }
+
+        // -----------------------------------------------------------------------------
+
+        static ctl::task_handle catch_exception(bool& caught)
+        {
+            try
+            {
+                co_await ctl::run_blocking([]() { throw std::runtime_error("blocking call failed"); });
+            }
+            catch (const std::runtime_error&)
+            {
+                caught = true;
+            }
+        }
+
+        // -----------------------------------------------------------------------------
+
+        static ctl::task_handle record_threads(std::thread::id& taskThread, std::thread::id& blockingThread)
+        {
+            taskThread = std::this_thread::get_id();
+
+            co_await ctl::run_blocking([&blockingThread]() { blockingThread = std::this_thread::get_id(); });
+        }
+
+        // -----------------------------------------------------------------------------
+
+        template< typename Queue >
+        static void run_until_released(Queue& queue, const ctl::const_task_counter_ptr& counter)
+        {
+            while (*counter > 0)
+            {
+                queue.run_until_idle();
+                std::this_thread::yield();
+            }
+        }
+
+        // -----------------------------------------------------------------------------
+
+        template< typename Queue >
+        static void check_runs_off_the_worker_thread()
+        {
+            Queue queue;
+
+            ctl::worker_pool_config config;
+            config.minWorkers = 1;
+            config.maxWorkers = 1;
+
+            queue.start_workers(config);
+
+            std::thread::id taskThread;
+            std::thread::id blockingThread;
+
+            ctl::task_counter_ptr counter = queue.push_waitable_task([&]() { return record_threads(taskThread, blockingThread); });
+
+            while (*counter > 0)
+            {
+                std::this_thread::yield();
+            }
+
+            Assert::IsTrue(blockingThread != std::thread::id(), L"Function should have run");
+            Assert::IsTrue(blockingThread != taskThread, L"Function should not run on the worker");
+        }
+
+        // -----------------------------------------------------------------------------
+
+        TEST_METHOD(result_of_the_function_is_returned)
+        {
+            ctl::task_queue queue;
+            int result = 0;
+
+            run_until_released(queue, queue.push_waitable_task([&result]() { return store_result(result); }));
+
+            Assert::AreEqual(42, result);
+            Assert::IsTrue(queue.get_blocking_pool().get_metrics().offloadedCalls == 1);
+        }
+
+        // -----------------------------------------------------------------------------
+
+        TEST_METHOD(exception_from_the_function_is_rethrown)
+        {
+            ctl::task_queue queue;
+            bool caught = false;
+
+            run_until_released(queue, queue.push_waitable_task([&caught]() { return catch_exception(caught); }));
+
+            Assert::IsTrue(caught);
+        }
+
+        // -----------------------------------------------------------------------------
+
+        TEST_METHOD(function_runs_off_the_worker_thread)
+        {
+            check_runs_off_the_worker_thread<ctl::task_queue>();
+        }
+
+        // -----------------------------------------------------------------------------
+
+        TEST_METHOD(function_runs_off_the_worker_thread_whatever_the_queue_policies)
+        {
+            check_runs_off_the_worker_thread<uninstrumented_task_queue>();
+        }
+
+        // -----------------------------------------------------------------------------
+
+        TEST_METHOD(function_runs_inline_off_a_queue)
+        {
+            std::thread::id taskThread;
+            std::thread::id blockingThread;
+
+            ctl::task_handle handle = record_threads(taskThread, blockingThread);
+
+            Assert::IsTrue(handle.complete());
+            Assert::IsTrue(blockingThread == std::this_thread::get_id());
+        }
+
+        // -----------------------------------------------------------------------------
+
+        TEST_METHOD(throwing_blocking_task_still_releases_its_counter)
+        {
+            ctl::task_queue queue;
+
+            ctl::task_counter_ptr counter = queue.push_waitable_blocking_task([]() { throw std::runtime_error("blocking task failed"); });
+
+            while (*counter > 0)
+            {
+                std::this_thread::yield();
+            }
+
+            Assert::IsTrue(*counter == 0);
+        }
+    };
+
+    // -----------------------------------------------------------------------------
+
+    TEST_CLASS(blocking_pool)
+    {
+    public:
+
+        TEST_METHOD(threads_are_capped_and_calls_over_the_cap_are_counted)
+        {
+            ctl::blocking_pool pool;
+            pool.set_max_threads(2);
+
+            std::atomic<bool> release = false;
+            std::atomic<int> finished = 0;
+
+            for (int i = 0; i < 4; ++i)
+            {
+                pool.push([&]()
+                {
+                    while (!release)
+                    {
+                        std::this_thread::yield();
+                    }
+
+                    ++finished;
+                });
+            }
+
+            const ctl::blocking_pool_metrics metrics = pool.get_metrics();
+
+            release = true;
+
+            while (finished < 4)
+            {
+                std::this_thread::yield();
+            }
+
+            Assert::IsTrue(metrics.offloadedCalls == 4);
+            Assert::IsTrue(metrics.threadsStarted == 2);
+            Assert::IsTrue(metrics.peakThreads == 2);
+            Assert::IsTrue(metrics.saturatedCalls == 2);
+        }
+
+        // -----------------------------------------------------------------------------
+
+        TEST_METHOD(idle_threads_are_reaped)
+        {
+            ctl::blocking_pool pool;
+            pool.set_idle_timeout(std::chrono::milliseconds(1));
+
+            std::atomic<bool> finished = false;
+
+            pool.push([&finished]() { finished = true; });
+
+            const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+
+            while (pool.get_metrics().threadsReaped == 0 && std::chrono::steady_clock::now() < deadline)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+
+            Assert::IsTrue(finished);
+            Assert::IsTrue(pool.get_metrics().threadsStarted == 1);
+            Assert::IsTrue(pool.get_metrics().threadsReaped == 1);
+        }
+    };
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
@@ -0,0 +1,186 @@
+#include <CppUnitTest.h>
+#include <ctl/strand.h>
+#include <ctl/task_queue.h>
+
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+// -----------------------------------------------------------------------------
+
+namespace ctl_test
+{
+    TEST_CLASS(strand)
+    {
+    public:
+
+        struct overlap_check
+        {
+            int m_running = 0;
+            bool m_overlapped = false;
+        };
+
+        // -----------------------------------------------------------------------------
+
+        static ctl::task_handle record(std::vector<int>& order, const int index)
+        {
+            order.push_back(index);
+            co_return;
+        }
+
+        // -----------------------------------------------------------------------------
+
+        // Only touches state shared with the other tasks of the strand, without locking.
+        static ctl::task_handle suspend_while_running(overlap_check& check, std::vector<int>& order, const int index)
+        {
+            check.m_overlapped |= ++check.m_running != 1;
+
+            co_await std::suspend_always{};
+
+            check.m_overlapped |= check.m_running != 1;
+            order.push_back(index);
+            --check.m_running;
+        }
+
+        // -----------------------------------------------------------------------------
+
+        static void start_workers(ctl::task_queue& queue)
+        {
+            ctl::worker_pool_config config;
+            config.minWorkers = 4;
+            config.maxWorkers = 4;
+
+            queue.start_workers(config);
+        }
+
+        // -----------------------------------------------------------------------------
+
+        static void wait_for(const ctl::const_task_counter_ptr& counter)
+        {
+            while (*counter > 0)
+            {
+                std::this_thread::yield();
+            }
+        }
+
+        // -----------------------------------------------------------------------------
+
+        TEST_METHOD(tasks_run_in_push_order)
+        {
+            ctl::task_queue queue;
+            start_workers(queue);
+
+            ctl::strand strand(queue, 4);
+            std::vector<int> order;
+            ctl::task_counter_ptr last;
+
+            for (int i = 0; i < 2000; ++i)
+            {
+                last = strand.push_waitable_task([&order, i]() { return record(order, i); });
+            }
+
+            wait_for(last);
+
+            Assert::AreEqual(size_t(2000), order.size());
+
+            for (int i = 0; i < 2000; ++i)
+            {
+                Assert::AreEqual(i, order[i]);
+            }
+        }
+
+        // -----------------------------------------------------------------------------
+
+        TEST_METHOD(task_does_not_start_until_the_previous_one_completes)
+        {
+            ctl::task_queue queue;
+            start_workers(queue);
+
+            ctl::strand strand(queue, 4);
+            overlap_check check;
+            std::vector<int> order;
+            ctl::task_counter_ptr last;
+
+            for (int i = 0; i < 500; ++i)
+            {
+                last = strand.push_waitable_task([&check, &order, i]() { return suspend_while_running(check, order, i); });
+            }
+
+            wait_for(last);
+
+            Assert::IsFalse(check.m_overlapped, L"Tasks of a strand should never overlap");
+            Assert::AreEqual(size_t(500), order.size());
+        }
+
+        // -----------------------------------------------------------------------------
+
+        TEST_METHOD(strand_occupies_at_most_one_queue_entry)
+        {
+            ctl::task_queue queue;
+            ctl::strand strand(queue);
+            std::vector<int> order;
+
+            for (int i = 0; i < 10; ++i)
+            {
+                strand.push_task([&order, i]() { return record(order, i); });
+            }
+
+            Assert::IsTrue(queue.get_instrumentation().pushes == 1);
+
+            queue.run_until_idle();
+
+            Assert::AreEqual(size_t(10), order.size());
+        }
+
+        // -----------------------------------------------------------------------------
+
+        TEST_METHOD(strand_yields_its_entry_after_each_batch)
+        {
+            ctl::task_queue queue;
+            ctl::strand strand(queue, 2);
+            std::vector<int> order;
+
+            for (int i = 0; i < 4; ++i)
+            {
+                strand.push_task([&order, i]() { return record(order, i); });
+            }
+
+            queue.push_task([&order]() { return record(order, -1); });
+            queue.run_until_idle();
+
+            Assert::IsTrue(order == std::vector<int>{ 0, 1, -1, 2, 3 });
+        }
+
+        // -----------------------------------------------------------------------------
+
+        TEST_METHOD(task_which_throws_before_returning_does_not_stall_the_strand)
+        {
+            ctl::task_queue queue;
+            ctl::strand strand(queue);
+            std::vector<int> order;
+
+            ctl::task_counter_ptr failed = strand.push_waitable_task([]() -> ctl::task_handle { throw std::runtime_error("task failed"); });
+            ctl::task_counter_ptr next = strand.push_waitable_task([&order]() { return record(order, 1); });
+
+            queue.run_until_idle();
+
+            Assert::IsTrue(*failed == 0, L"Counter of the failed task should have been released");
+            Assert::IsTrue(*next == 0, L"Strand should have carried on after the failure");
+
+            ctl::task_counter_ptr later = strand.push_waitable_task([&order]() { return record(order, 2); });
+
+            queue.run_until_idle();
+
+            Assert::IsTrue(*later == 0, L"Strand should still be scheduled by later pushes");
+            Assert::IsTrue(order == std::vector<int>{ 1, 2 });
+        }
+    };
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
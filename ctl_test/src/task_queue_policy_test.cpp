@@ -0,0 +1,231 @@
+#include <CppUnitTest.h>
+#include <ctl/task_queue.h>
+#include <ctl/task_queue_policies.h>
+
+#include <atomic>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+// -----------------------------------------------------------------------------
+
+namespace ctl_test
+{
+    TEST_CLASS(task_queue_policy)
+    {
+    public:
+
+        template< typename... T >
+        struct type_list
+        {
+        };
+
+        using queue_policies = type_list<ctl::fifo_queue, ctl::lifo_queue>;
+        using wake_policies = type_list<ctl::condition_variable_wake, ctl::spin_wake, ctl::single_thread_wake>;
+        using threaded_wake_policies = type_list<ctl::condition_variable_wake, ctl::spin_wake>;
+        using counter_policies = type_list<ctl::tracked_counters, ctl::polled_counters, ctl::no_counters>;
+        using storage_policies = type_list<ctl::inline_storage, ctl::function_storage>;
+        using instrumentation_policies = type_list<ctl::no_instrumentation, ctl::counting_instrumentation>;
+
+        // -----------------------------------------------------------------------------
+
+        static ctl::task_handle increment(std::atomic<int>& completed)
+        {
+            ++completed;
+            co_return;
+        }
+
+        // -----------------------------------------------------------------------------
+
+        static ctl::task_handle increment_after_yield(std::atomic<int>& completed)
+        {
+            co_await std::suspend_always{};
+            ++completed;
+        }
+
+        // -----------------------------------------------------------------------------
+
+        static ctl::task_handle increment_after(ctl::const_task_counter_ptr counter, std::atomic<int>& completed)
+        {
+            co_await ctl::suspend_until(counter);
+            Assert::IsTrue(*counter == 0, L"Task resumed before its counter was released");
+            ++completed;
+        }
+
+        // -----------------------------------------------------------------------------
+
+        static ctl::task_handle record(std::vector<int>& order, const int index, const bool yieldFirst)
+        {
+            if (yieldFirst)
+            {
+                co_await std::suspend_always{};
+            }
+
+            order.push_back(index);
+        }
+
+        // -----------------------------------------------------------------------------
+
+        template< typename Policies >
+        static void run_workload()
+        {
+            ctl::basic_task_queue<Policies> queue;
+
+            std::atomic<int> completed = 0;
+            int expected = 0;
+            size_t pushes = 0;
+
+            std::vector<ctl::task_function> functions(4, [&completed]() { return increment(completed); });
+
+            queue.push_tasks(functions);
+            queue.push_task([&completed]() { return increment_after_yield(completed); });
+            expected += 5;
+            pushes += 5;
+
+            if constexpr (Policies::counter_policy::enabled)
+            {
+                ctl::task_counter_ptr counter = queue.push_waitable_tasks(functions);
+                queue.push_task([&completed, counter]() { return increment_after(counter, completed); });
+                expected += 5;
+                pushes += 5;
+            }
+
+            queue.run_until_idle();
+
+            Assert::AreEqual(expected, completed.load());
+
+            if constexpr (std::is_same_v<typename Policies::instrumentation_policy, ctl::counting_instrumentation>)
+            {
+                Assert::IsTrue(pushes == queue.get_instrumentation().pushes);
+            }
+        }
+
+        // -----------------------------------------------------------------------------
+
+        // The same tasks, pushed from this thread while scaling workers run them.
+        template< typename Policies >
+        static void run_threaded_workload()
+        {
+            std::atomic<int> completed = 0;
+            int expected = 0;
+
+            ctl::basic_task_queue<Policies> queue;
+
+            ctl::worker_pool_config config;
+            config.minWorkers = 2;
+            config.maxWorkers = 4;
+
+            queue.start_workers(config);
+
+            std::vector<ctl::task_function> functions(4, [&completed]() { return increment(completed); });
+
+            for (int i = 0; i < 50; ++i)
+            {
+                queue.push_tasks(functions);
+                queue.push_task([&completed]() { return increment_after_yield(completed); });
+                expected += 5;
+
+                if constexpr (Policies::counter_policy::enabled)
+                {
+                    ctl::task_counter_ptr counter = queue.push_waitable_tasks(functions);
+                    queue.push_task([&completed, counter]() { return increment_after(counter, completed); });
+                    expected += 5;
+                }
+            }
+
+            while (completed < expected)
+            {
+                std::this_thread::yield();
+            }
+
+            Assert::AreEqual(expected, completed.load());
+        }
+
+        // -----------------------------------------------------------------------------
+
+        template< bool Threaded, typename... Chosen >
+        static void run_combinations(type_list<Chosen...>)
+        {
+            if constexpr (Threaded)
+            {
+                run_threaded_workload<ctl::task_queue_policies<Chosen...>>();
+            }
+            else
+            {
+                run_workload<ctl::task_queue_policies<Chosen...>>();
+            }
+        }
+
+        // -----------------------------------------------------------------------------
+
+        template< bool Threaded, typename... Chosen, typename... Options, typename... Remaining >
+        static void run_combinations(type_list<Chosen...>, type_list<Options...>, Remaining... remaining)
+        {
+            (run_combinations<Threaded>(type_list<Chosen..., Options>(), remaining...), ...);
+        }
+
+        // -----------------------------------------------------------------------------
+
+        TEST_METHOD(every_policy_combination_runs_all_tasks)
+        {
+            run_combinations<false>(type_list<>(), queue_policies(), wake_policies(), counter_policies(), storage_policies(), instrumentation_policies());
+        }
+
+        // -----------------------------------------------------------------------------
+
+        TEST_METHOD(every_threaded_policy_combination_runs_all_tasks_on_workers)
+        {
+            run_combinations<true>(type_list<>(), queue_policies(), threaded_wake_policies(), counter_policies(), storage_policies(), instrumentation_policies());
+        }
+
+        // -----------------------------------------------------------------------------
+
+        TEST_METHOD(lifo_queue_runs_newest_first_and_requeues_at_the_cold_end)
+        {
+            ctl::basic_task_queue<ctl::task_queue_policies<ctl::lifo_queue, ctl::single_thread_wake, ctl::no_counters, ctl::inline_storage, ctl::no_instrumentation>> queue;
+            std::vector<int> order;
+
+            for (int i = 0; i < 100; ++i)
+            {
+                queue.push_task([&order, i]() { return record(order, i, i == 99); });
+            }
+
+            queue.run_until_idle();
+
+            Assert::AreEqual(size_t(100), order.size());
+
+            for (int i = 0; i < 99; ++i)
+            {
+                Assert::AreEqual(98 - i, order[i]);
+            }
+
+            Assert::AreEqual(99, order[99]);
+        }
+
+        // -----------------------------------------------------------------------------
+
+        TEST_METHOD(single_thread_queue_without_counters_is_only_its_container)
+        {
+            using minimal_task_queue = ctl::basic_task_queue<ctl::task_queue_policies<ctl::fifo_queue, ctl::single_thread_wake, ctl::no_counters, ctl::inline_storage, ctl::no_instrumentation>>;
+            using task_container = ctl::fifo_queue::container<ctl::impl::basic_task<false>>;
+
+            // Besides the container, only the pointer to the context interface remains.
+            Assert::IsTrue(sizeof(minimal_task_queue) <= sizeof(task_container) + sizeof(void*));
+        }
+
+        // -----------------------------------------------------------------------------
+
+        TEST_METHOD(default_task_queue_uses_default_policies)
+        {
+            Assert::IsTrue(std::is_same_v<ctl::task_queue, ctl::basic_task_queue<ctl::default_task_queue_policies>>);
+        }
+    };
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
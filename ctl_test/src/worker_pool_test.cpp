@@ -0,0 +1,193 @@
+#include <CppUnitTest.h>
+#include <ctl/task_queue.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+// -----------------------------------------------------------------------------
+
+namespace ctl_test
+{
+    TEST_CLASS(worker_pool)
+    {
+    public:
+
+        struct concurrency_check
+        {
+            std::atomic<int> m_running = 0;
+            std::atomic<int> m_peak = 0;
+        };
+
+        // -----------------------------------------------------------------------------
+
+        static ctl::task_handle sleep_for(concurrency_check& check, const std::chrono::milliseconds duration)
+        {
+            const int running = ++check.m_running;
+            int peak = check.m_peak;
+
+            while (running > peak && !check.m_peak.compare_exchange_weak(peak, running))
+            {
+            }
+
+            std::this_thread::sleep_for(duration);
+
+            --check.m_running;
+            co_return;
+        }
+
+        // -----------------------------------------------------------------------------
+
+        static std::vector<ctl::task_function> sleeping_tasks(concurrency_check& check, const size_t count, const std::chrono::milliseconds duration)
+        {
+            return std::vector<ctl::task_function>(count, [&check, duration]() { return sleep_for(check, duration); });
+        }
+
+        // -----------------------------------------------------------------------------
+
+        static void wait_for(const ctl::const_task_counter_ptr& counter)
+        {
+            while (*counter > 0)
+            {
+                std::this_thread::yield();
+            }
+        }
+
+        // -----------------------------------------------------------------------------
+
+        template< typename Predicate >
+        static bool wait_until(Predicate predicate)
+        {
+            const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+
+            while (!predicate())
+            {
+                if (std::chrono::steady_clock::now() >= deadline)
+                {
+                    return false;
+                }
+
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+
+            return true;
+        }
+
+        // -----------------------------------------------------------------------------
+
+        TEST_METHOD(burst_pushed_at_once_activates_parked_workers)
+        {
+            concurrency_check check;
+            ctl::task_queue queue;
+
+            ctl::worker_pool_config config;
+            config.minWorkers = 1;
+            config.maxWorkers = 8;
+            config.standbyWorkers = 2;
+
+            queue.start_workers(config);
+
+            wait_for(queue.push_waitable_tasks(sleeping_tasks(check, 64, std::chrono::milliseconds(5))));
+
+            const ctl::worker_pool_stats stats = queue.get_worker_stats();
+
+            Assert::IsTrue(stats.activations >= 2, L"Both standby workers should have been activated");
+            Assert::IsTrue(stats.threadsStarted == 8);
+            Assert::IsTrue(check.m_peak >= 3, L"Tasks of the burst should have run side by side");
+        }
+
+        // -----------------------------------------------------------------------------
+
+        TEST_METHOD(idle_workers_park_back_down_to_min_workers)
+        {
+            concurrency_check check;
+            ctl::task_queue queue;
+
+            ctl::worker_pool_config config;
+            config.minWorkers = 1;
+            config.maxWorkers = 4;
+            config.standbyWorkers = 0;
+            config.shrinkIdleTime = std::chrono::milliseconds(1);
+
+            queue.start_workers(config);
+
+            wait_for(queue.push_waitable_tasks(sleeping_tasks(check, 32, std::chrono::milliseconds(2))));
+
+            Assert::IsTrue(wait_until([&queue]() { return queue.get_worker_stats().activeWorkers == 1; }), L"Idle workers should have parked");
+
+            const ctl::worker_pool_stats stats = queue.get_worker_stats();
+
+            Assert::IsTrue(stats.threadsStarted == 4);
+            Assert::IsTrue(stats.parks == 3);
+            Assert::IsTrue(stats.parkedWorkers == 3);
+        }
+
+        // -----------------------------------------------------------------------------
+
+        TEST_METHOD(max_workers_is_never_exceeded)
+        {
+            concurrency_check check;
+            ctl::task_queue queue;
+
+            ctl::worker_pool_config config;
+            config.minWorkers = 1;
+            config.maxWorkers = 3;
+            config.standbyWorkers = 2;
+
+            queue.start_workers(config);
+
+            for (int i = 0; i < 10; ++i)
+            {
+                ctl::task_counter_ptr counter = queue.push_waitable_tasks(sleeping_tasks(check, 16, std::chrono::milliseconds(1)));
+
+                for (int j = 0; j < 16; ++j)
+                {
+                    queue.push_task([&check]() { return sleep_for(check, std::chrono::milliseconds(1)); });
+                }
+
+                wait_for(counter);
+            }
+
+            const ctl::worker_pool_stats stats = queue.get_worker_stats();
+
+            Assert::IsTrue(check.m_peak <= 3);
+            Assert::IsTrue(stats.threadsStarted <= 3);
+            Assert::IsTrue(stats.activeWorkers + stats.parkedWorkers <= 3);
+        }
+
+        // -----------------------------------------------------------------------------
+
+        TEST_METHOD(destructor_joins_workers_which_are_still_parked)
+        {
+            ctl::worker_pool_stats stats;
+            {
+                concurrency_check check;
+                ctl::task_queue queue;
+
+                ctl::worker_pool_config config;
+                config.minWorkers = 1;
+                config.maxWorkers = 4;
+                config.standbyWorkers = 3;
+
+                queue.start_workers(config);
+
+                wait_for(queue.push_waitable_task([&check]() { return sleep_for(check, std::chrono::milliseconds(1)); }));
+
+                stats = queue.get_worker_stats();
+            }
+
+            Assert::IsTrue(stats.parkedWorkers == 3);
+            Assert::IsTrue(stats.activations == 0);
+        }
+    };
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------